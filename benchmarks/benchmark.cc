@@ -230,6 +230,31 @@ static void BM_LoadAdsDescriptor_Proto2(benchmark::State& state) {
 BENCHMARK_TEMPLATE(BM_LoadAdsDescriptor_Proto2, NoLayout);
 BENCHMARK_TEMPLATE(BM_LoadAdsDescriptor_Proto2, WithLayout);
 
+// Looks up already-built symbols in the generated pool from many threads at
+// once, to measure lock contention on the lookup path.
+static void BM_FindFileContainingSymbol_Proto2(benchmark::State& state) {
+  const protobuf::DescriptorPool* pool =
+      protobuf::DescriptorPool::generated_pool();
+  const char* const kSymbols[] = {
+      "upb_benchmark.FileDescriptorProto",
+      "upb_benchmark.DescriptorProto",
+      "upb_benchmark.FieldDescriptorProto.Type",
+      "upb_benchmark.FieldOptions.ctype",
+  };
+  // Make sure the file is built before timing starts.
+  if (pool->FindFileContainingSymbol(kSymbols[0]) == nullptr) {
+    printf("Failed to find symbol.\n");
+    exit(1);
+  }
+  size_t i = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(pool->FindFileContainingSymbol(
+        kSymbols[i++ % (sizeof(kSymbols) / sizeof(kSymbols[0]))]));
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_FindFileContainingSymbol_Proto2)->ThreadRange(1, 64);
+
 enum CopyStrings {
   Copy,
   Alias,
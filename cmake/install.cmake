@@ -63,6 +63,7 @@ install(FILES ${CMAKE_CURRENT_BINARY_DIR}/protobuf.pc ${CMAKE_CURRENT_BINARY_DIR
 include(${protobuf_SOURCE_DIR}/src/file_lists.cmake)
 set(protobuf_HEADERS
   ${libprotobuf_hdrs}
+  ${libprotobuf_optional_hdrs}
   ${libprotoc_hdrs}
   ${wkt_protos_files}
   ${cpp_features_proto_proto_srcs}
@@ -3,9 +3,28 @@
 include(${protobuf_SOURCE_DIR}/src/file_lists.cmake)
 include(${protobuf_SOURCE_DIR}/cmake/protobuf-configure-target.cmake)
 
+# The Zstandard and LZ4 streams depend on optional libraries, so they are not
+# in the generated file lists.
+set(libprotobuf_optional_srcs)
+set(libprotobuf_optional_hdrs)
+if(HAVE_ZSTD)
+  list(APPEND libprotobuf_optional_srcs
+    ${protobuf_SOURCE_DIR}/src/google/protobuf/io/zstd_stream.cc)
+  list(APPEND libprotobuf_optional_hdrs
+    ${protobuf_SOURCE_DIR}/src/google/protobuf/io/zstd_stream.h)
+endif()
+if(HAVE_LZ4)
+  list(APPEND libprotobuf_optional_srcs
+    ${protobuf_SOURCE_DIR}/src/google/protobuf/io/lz4_stream.cc)
+  list(APPEND libprotobuf_optional_hdrs
+    ${protobuf_SOURCE_DIR}/src/google/protobuf/io/lz4_stream.h)
+endif()
+
 add_library(libprotobuf ${protobuf_SHARED_OR_STATIC}
   ${libprotobuf_srcs}
   ${libprotobuf_hdrs}
+  ${libprotobuf_optional_srcs}
+  ${libprotobuf_optional_hdrs}
   ${protobuf_version_rc_file})
 if(protobuf_HAVE_LD_VERSION_SCRIPT)
   if(${CMAKE_VERSION} VERSION_GREATER 3.13 OR ${CMAKE_VERSION} VERSION_EQUAL 3.13)
@@ -20,6 +39,12 @@ target_link_libraries(libprotobuf PRIVATE ${CMAKE_THREAD_LIBS_INIT})
 if(protobuf_WITH_ZLIB)
   target_link_libraries(libprotobuf PRIVATE ${ZLIB_LIBRARIES})
 endif()
+if(HAVE_ZSTD)
+  target_link_libraries(libprotobuf PRIVATE ${ZSTD_LIBRARY})
+endif()
+if(HAVE_LZ4)
+  target_link_libraries(libprotobuf PRIVATE ${LZ4_LIBRARY})
+endif()
 if(protobuf_LINK_LIBATOMIC)
   target_link_libraries(libprotobuf PRIVATE atomic)
 endif()
@@ -113,6 +113,13 @@ if(protobuf_BUILD_SHARED_LIBS)
 endif()
 
 add_executable(tests ${tests_files} ${common_test_files})
+# The Zstandard and LZ4 stream tests are only compiled in when the library is.
+if (HAVE_ZSTD)
+  target_compile_definitions(tests PRIVATE HAVE_ZSTD)
+endif ()
+if (HAVE_LZ4)
+  target_compile_definitions(tests PRIVATE HAVE_LZ4)
+endif ()
 if (MSVC)
   target_compile_options(tests PRIVATE
     /wd4146 # unary minus operator applied to unsigned type, result still unsigned
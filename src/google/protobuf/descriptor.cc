@@ -2133,6 +2133,13 @@ void DescriptorPool::InternalAddGeneratedFile(
 
 const FileDescriptor* DescriptorPool::FindFileByName(
     absl::string_view name) const {
+  // A faster path to reduce lock contention in finding files, assuming most
+  // files have already been built.
+  if (mutex_ != nullptr) {
+    absl::ReaderMutexLock lock(mutex_);
+    const FileDescriptor* result = tables_->FindFile(name);
+    if (result != nullptr) return result;
+  }
   absl::MutexLockMaybe lock(mutex_);
   if (fallback_database_ != nullptr) {
     tables_->known_bad_symbols_.clear();
@@ -2153,6 +2160,13 @@ const FileDescriptor* DescriptorPool::FindFileByName(
 
 const FileDescriptor* DescriptorPool::FindFileContainingSymbol(
     absl::string_view symbol_name) const {
+  // A faster path to reduce lock contention in finding symbols, assuming most
+  // symbols are already in the tables.
+  if (mutex_ != nullptr) {
+    absl::ReaderMutexLock lock(mutex_);
+    Symbol result = tables_->FindSymbol(symbol_name);
+    if (!result.IsNull()) return result.GetFile();
+  }
   absl::MutexLockMaybe lock(mutex_);
   if (fallback_database_ != nullptr) {
     tables_->known_bad_symbols_.clear();
@@ -4542,6 +4556,87 @@ const FileDescriptor* DescriptorPool::BuildFileCollectingErrors(
       ->BuildFile(proto);
 }
 
+namespace {
+
+// Returns the indices of `protos` ordered so that each file comes after the
+// files it imports from within `protos`.  Files caught in an import cycle
+// keep their relative order; the builder reports the unresolved import.
+std::vector<size_t> OrderByDependencies(
+    absl::Span<const FileDescriptorProto> protos) {
+  absl::flat_hash_map<absl::string_view, size_t> index_by_name;
+  index_by_name.reserve(protos.size());
+  for (size_t i = 0; i < protos.size(); ++i) {
+    index_by_name.emplace(protos[i].name(), i);
+  }
+
+  enum State : uint8_t { kUnvisited, kVisiting, kDone };
+  std::vector<State> state(protos.size(), kUnvisited);
+  std::vector<size_t> order;
+  order.reserve(protos.size());
+
+  // Iterative post-order DFS so that deep import chains can't overflow the
+  // stack.  Each entry is a file index and the next dependency to visit.
+  std::vector<std::pair<size_t, int>> stack;
+  for (size_t root = 0; root < protos.size(); ++root) {
+    if (state[root] != kUnvisited) continue;
+    state[root] = kVisiting;
+    stack.emplace_back(root, 0);
+    while (!stack.empty()) {
+      size_t index = stack.back().first;
+      int& next = stack.back().second;
+      const FileDescriptorProto& proto = protos[index];
+      if (next < proto.dependency_size()) {
+        auto it = index_by_name.find(proto.dependency(next++));
+        if (it != index_by_name.end() && state[it->second] == kUnvisited) {
+          state[it->second] = kVisiting;
+          stack.emplace_back(it->second, 0);
+        }
+        continue;
+      }
+      state[index] = kDone;
+      order.push_back(index);
+      stack.pop_back();
+    }
+  }
+  return order;
+}
+
+}  // namespace
+
+std::vector<const FileDescriptor*> DescriptorPool::BuildFiles(
+    absl::Span<const FileDescriptorProto> protos) {
+  return BuildFilesCollectingErrors(protos, nullptr);
+}
+
+std::vector<const FileDescriptor*> DescriptorPool::BuildFilesCollectingErrors(
+    absl::Span<const FileDescriptorProto> protos,
+    ErrorCollector* error_collector) {
+  ABSL_CHECK(fallback_database_ == nullptr)
+      << "Cannot call BuildFiles on a DescriptorPool that uses a "
+         "DescriptorDatabase.  You must instead find a way to get your files "
+         "into the underlying database.";
+  ABSL_CHECK(mutex_ == nullptr);  // Implied by the above ABSL_CHECK.
+  tables_->known_bad_symbols_.clear();
+  tables_->known_bad_files_.clear();
+  build_started_ = true;
+
+  // One checkpoint spans the whole batch.  Each file's own checkpoint nests
+  // inside it, so nothing is committed until every file has been built, and
+  // a failure rolls back the files built before it.
+  std::vector<const FileDescriptor*> result(protos.size());
+  tables_->AddCheckpoint();
+  for (size_t index : OrderByDependencies(protos)) {
+    result[index] = DescriptorBuilder::New(this, tables_.get(), error_collector)
+                        ->BuildFile(protos[index]);
+    if (result[index] == nullptr) {
+      tables_->RollbackToLastCheckpoint();
+      return {};
+    }
+  }
+  tables_->ClearLastCheckpoint();
+  return result;
+}
+
 const FileDescriptor* DescriptorPool::BuildFileFromDatabase(
     const FileDescriptorProto& proto) const {
   mutex_->AssertHeld();
@@ -52,6 +52,7 @@
 #include "absl/strings/string_view.h"
 #include "absl/synchronization/mutex.h"
 #include "absl/types/optional.h"
+#include "absl/types/span.h"
 #include "google/protobuf/descriptor_lite.h"
 #include "google/protobuf/extension_set.h"
 #include "google/protobuf/port.h"
@@ -2210,6 +2211,21 @@ class PROTOBUF_EXPORT DescriptorPool {
   const FileDescriptor* BuildFileCollectingErrors(
       const FileDescriptorProto& proto, ErrorCollector* error_collector);
 
+  // Builds a batch of files as a single unit.  Unlike BuildFile(), the files
+  // in `protos` may import each other and may appear in any order; each file
+  // is built after the files it imports from the same batch.  Imports that
+  // are not part of the batch must already be in the pool.  On success,
+  // returns the FileDescriptors in the same order as `protos`.  If any file
+  // fails to build, none of the files in the batch are added to the pool and
+  // an empty vector is returned.
+  std::vector<const FileDescriptor*> BuildFiles(
+      absl::Span<const FileDescriptorProto> protos);
+
+  // Same as BuildFiles() except errors are sent to the given ErrorCollector.
+  std::vector<const FileDescriptor*> BuildFilesCollectingErrors(
+      absl::Span<const FileDescriptorProto> protos,
+      ErrorCollector* error_collector);
+
   // By default, it is an error if a FileDescriptorProto contains references
   // to types or other files that are not found in the DescriptorPool (or its
   // backing DescriptorDatabase, if any).  If you call
@@ -12,16 +12,23 @@
 #include "google/protobuf/descriptor_database.h"
 
 #include <algorithm>
+#include <cstdint>
 #include <string>
 #include <utility>
 #include <vector>
 
 #include "absl/container/btree_set.h"
+#include "absl/log/absl_check.h"
+#include "absl/log/absl_log.h"
 #include "absl/strings/ascii.h"
 #include "absl/strings/match.h"
 #include "absl/strings/str_replace.h"
 #include "absl/strings/string_view.h"
+#include "absl/strings/strip.h"
+#include "absl/types/optional.h"
 #include "google/protobuf/descriptor.pb.h"
+#include "google/protobuf/io/coded_stream.h"
+#include "google/protobuf/wire_format_lite.h"
 
 
 namespace google {
@@ -415,10 +422,30 @@ class EncodedDescriptorDatabase::DescriptorIndex {
 
   void EnsureFlat();
 
-  using String = std::string;
+  // Every string in the index is a substring of the encoded file it came
+  // from, and the caller keeps those bytes alive for the life of the database.
+  // So strings are stored as a range within that file's bytes rather than as
+  // copies, which keeps each entry small and avoids an allocation per name.
+  struct String {
+    uint32_t offset;
+    uint32_t size;
+  };
 
-  String EncodeString(absl::string_view str) const { return String(str); }
-  absl::string_view DecodeString(const String& str, int) const { return str; }
+  // `str` must point into the encoded file most recently added to
+  // `all_values_`.
+  String EncodeString(absl::string_view str) const {
+    if (str.empty()) return {0, 0};
+    const char* base = static_cast<const char*>(all_values_.back().data);
+    ABSL_DCHECK(str.data() >= base &&
+                str.data() + str.size() <= base + all_values_.back().size);
+    return {static_cast<uint32_t>(str.data() - base),
+            static_cast<uint32_t>(str.size())};
+  }
+  absl::string_view DecodeString(const String& str, int data_offset) const {
+    return absl::string_view(
+        static_cast<const char*>(all_values_[data_offset].data) + str.offset,
+        str.size);
+  }
 
   struct EncodedEntry {
     // Do not use `Value` here to avoid the padding of that object.
@@ -471,6 +498,18 @@ class EncodedDescriptorDatabase::DescriptorIndex {
       auto p = package(index);
       return absl::StrCat(p, p.empty() ? "" : ".", symbol(index));
     }
+
+    // Same as IsSubSymbol(AsString(index), name), without building the
+    // fully-qualified name.
+    bool IsSuperSymbolOf(const DescriptorIndex& index,
+                         absl::string_view name) const {
+      auto p = package(index);
+      if (!p.empty() &&
+          !(absl::ConsumePrefix(&name, p) && absl::ConsumePrefix(&name, "."))) {
+        return false;
+      }
+      return IsSubSymbol(symbol(index), name);
+    }
   };
 
   struct SymbolCompare {
@@ -541,10 +580,212 @@ class EncodedDescriptorDatabase::DescriptorIndex {
   std::vector<ExtensionEntry> by_extension_flat_;
 };
 
+namespace {
+
+// The subset of an encoded FileDescriptorProto that DescriptorIndex::AddFile()
+// reads.  Strings alias the encoded bytes, and every other field is skipped, so
+// registering a file does not materialize its fields, options or source info.
+// This is what every generated file pays for at startup, so it matters.
+struct IndexFieldProto {
+  absl::string_view name() const { return name_; }
+  absl::string_view extendee() const { return extendee_; }
+  int number() const { return number_; }
+
+  absl::string_view name_;
+  absl::string_view extendee_;
+  int number_ = 0;
+};
+
+struct IndexNamedProto {
+  absl::string_view name() const { return name_; }
+
+  absl::string_view name_;
+};
+
+struct IndexMessageProto {
+  absl::string_view name() const { return name_; }
+  const std::vector<IndexMessageProto>& nested_type() const {
+    return nested_type_;
+  }
+  const std::vector<IndexFieldProto>& extension() const { return extension_; }
+
+  absl::string_view name_;
+  std::vector<IndexMessageProto> nested_type_;
+  std::vector<IndexFieldProto> extension_;
+};
+
+struct IndexFileProto {
+  absl::string_view name() const { return name_; }
+  absl::string_view package() const { return package_; }
+  const std::vector<IndexMessageProto>& message_type() const {
+    return message_type_;
+  }
+  const std::vector<IndexNamedProto>& enum_type() const { return enum_type_; }
+  const std::vector<IndexFieldProto>& extension() const { return extension_; }
+  const std::vector<IndexNamedProto>& service() const { return service_; }
+
+  absl::string_view name_;
+  absl::string_view package_;
+  std::vector<IndexMessageProto> message_type_;
+  std::vector<IndexNamedProto> enum_type_;
+  std::vector<IndexFieldProto> extension_;
+  std::vector<IndexNamedProto> service_;
+};
+
+#define INDEX_TAG(NUMBER, TYPE)          \
+  GOOGLE_PROTOBUF_WIRE_FORMAT_MAKE_TAG( \
+      NUMBER, internal::WireFormatLite::WIRETYPE_##TYPE)
+
+// Reads a length-delimited field as a view into the flat input buffer.
+bool ReadView(io::CodedInputStream* input, absl::string_view* output) {
+  uint32_t length;
+  if (!input->ReadVarint32(&length)) return false;
+  if (length == 0) {
+    *output = absl::string_view();
+    return true;
+  }
+  const void* data;
+  int size;
+  if (!input->GetDirectBufferPointer(&data, &size) ||
+      static_cast<uint32_t>(size) < length) {
+    return false;
+  }
+  *output = absl::string_view(static_cast<const char*>(data), length);
+  return input->Skip(static_cast<int>(length));
+}
+
+// Calls `handle_field(tag, input)` for every field of the message encoded in
+// `data`, which is nested `depth` levels deep in the file.  Fields that
+// `handle_field` returns nullopt for are skipped.  Like ParseFromArray(), this
+// fails on input nested deeper than the default recursion limit, so that it
+// cannot overflow the stack.
+template <typename HandleField>
+bool ForEachField(absl::string_view data, int depth, HandleField handle_field) {
+  if (depth > io::CodedInputStream::GetDefaultRecursionLimit()) return false;
+  io::CodedInputStream input(reinterpret_cast<const uint8_t*>(data.data()),
+                             static_cast<int>(data.size()));
+  while (uint32_t tag = input.ReadTag()) {
+    absl::optional<bool> handled = handle_field(tag, &input);
+    if (handled.has_value() ? !*handled
+                            : !internal::WireFormatLite::SkipField(&input, tag)) {
+      return false;
+    }
+  }
+  return input.ConsumedEntireMessage();
+}
+
+// Reads a submessage of a message at `depth` with `parse`.
+template <typename Proto>
+bool ReadSubmessage(io::CodedInputStream* input, int depth,
+                    bool (*parse)(absl::string_view, int, Proto*),
+                    std::vector<Proto>* output) {
+  absl::string_view data;
+  if (!ReadView(input, &data)) return false;
+  output->emplace_back();
+  return parse(data, depth + 1, &output->back());
+}
+
+bool ParseIndexField(absl::string_view data, int depth,
+                     IndexFieldProto* field) {
+  return ForEachField(data, depth,
+                      [field](uint32_t tag, io::CodedInputStream* input)
+                          -> absl::optional<bool> {
+    switch (tag) {
+      case INDEX_TAG(FieldDescriptorProto::kNameFieldNumber, LENGTH_DELIMITED):
+        return ReadView(input, &field->name_);
+      case INDEX_TAG(FieldDescriptorProto::kExtendeeFieldNumber,
+                     LENGTH_DELIMITED):
+        return ReadView(input, &field->extendee_);
+      case INDEX_TAG(FieldDescriptorProto::kNumberFieldNumber, VARINT): {
+        uint32_t number;
+        if (!input->ReadVarint32(&number)) return false;
+        field->number_ = static_cast<int>(number);
+        return true;
+      }
+      default:
+        return absl::nullopt;
+    }
+  });
+}
+
+bool ParseIndexNamed(absl::string_view data, int depth,
+                     IndexNamedProto* named) {
+  // EnumDescriptorProto and ServiceDescriptorProto both use field 1 for name.
+  return ForEachField(data, depth,
+                      [named](uint32_t tag, io::CodedInputStream* input)
+                          -> absl::optional<bool> {
+    if (tag == INDEX_TAG(1, LENGTH_DELIMITED)) {
+      return ReadView(input, &named->name_);
+    }
+    return absl::nullopt;
+  });
+}
+
+bool ParseIndexMessage(absl::string_view data, int depth,
+                       IndexMessageProto* message) {
+  return ForEachField(data, depth,
+                      [message, depth](uint32_t tag, io::CodedInputStream* input)
+                          -> absl::optional<bool> {
+    switch (tag) {
+      case INDEX_TAG(DescriptorProto::kNameFieldNumber, LENGTH_DELIMITED):
+        return ReadView(input, &message->name_);
+      case INDEX_TAG(DescriptorProto::kNestedTypeFieldNumber,
+                     LENGTH_DELIMITED):
+        return ReadSubmessage(input, depth, &ParseIndexMessage,
+                              &message->nested_type_);
+      case INDEX_TAG(DescriptorProto::kExtensionFieldNumber, LENGTH_DELIMITED):
+        return ReadSubmessage(input, depth, &ParseIndexField,
+                              &message->extension_);
+      default:
+        return absl::nullopt;
+    }
+  });
+}
+
+bool ParseIndexFile(absl::string_view data, IndexFileProto* file) {
+  constexpr int kDepth = 0;
+  return ForEachField(data, kDepth,
+                      [file](uint32_t tag, io::CodedInputStream* input)
+                          -> absl::optional<bool> {
+    switch (tag) {
+      case INDEX_TAG(FileDescriptorProto::kNameFieldNumber, LENGTH_DELIMITED):
+        return ReadView(input, &file->name_);
+      case INDEX_TAG(FileDescriptorProto::kPackageFieldNumber,
+                     LENGTH_DELIMITED):
+        return ReadView(input, &file->package_);
+      case INDEX_TAG(FileDescriptorProto::kMessageTypeFieldNumber,
+                     LENGTH_DELIMITED):
+        return ReadSubmessage(input, kDepth, &ParseIndexMessage,
+                              &file->message_type_);
+      case INDEX_TAG(FileDescriptorProto::kEnumTypeFieldNumber,
+                     LENGTH_DELIMITED):
+        return ReadSubmessage(input, kDepth, &ParseIndexNamed,
+                              &file->enum_type_);
+      case INDEX_TAG(FileDescriptorProto::kServiceFieldNumber,
+                     LENGTH_DELIMITED):
+        return ReadSubmessage(input, kDepth, &ParseIndexNamed,
+                              &file->service_);
+      case INDEX_TAG(FileDescriptorProto::kExtensionFieldNumber,
+                     LENGTH_DELIMITED):
+        return ReadSubmessage(input, kDepth, &ParseIndexField,
+                              &file->extension_);
+      default:
+        return absl::nullopt;
+    }
+  });
+}
+
+#undef INDEX_TAG
+
+}  // namespace
+
 bool EncodedDescriptorDatabase::Add(const void* encoded_file_descriptor,
                                     int size) {
-  FileDescriptorProto file;
-  if (file.ParseFromArray(encoded_file_descriptor, size)) {
+  IndexFileProto file;
+  if (ParseIndexFile(
+          absl::string_view(static_cast<const char*>(encoded_file_descriptor),
+                            size),
+          &file)) {
     return index_->AddFile(file, std::make_pair(encoded_file_descriptor, size));
   } else {
     ABSL_LOG(ERROR) << "Invalid file descriptor data passed to "
@@ -772,8 +1013,7 @@ EncodedDescriptorDatabase::DescriptorIndex::FindSymbolOnlyFlat(
   auto iter =
       FindLastLessOrEqual(&by_symbol_flat_, name, by_symbol_.key_comp());
 
-  return iter != by_symbol_flat_.end() &&
-                 IsSubSymbol(iter->AsString(*this), name)
+  return iter != by_symbol_flat_.end() && iter->IsSuperSymbolOf(*this, name)
              ? all_values_[iter->data_offset].value()
              : Value();
 }
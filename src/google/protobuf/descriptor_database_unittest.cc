@@ -21,6 +21,7 @@
 #include "google/protobuf/testing/googletest.h"
 #include <gtest/gtest.h>
 #include "google/protobuf/descriptor.h"
+#include "google/protobuf/io/coded_stream.h"
 #include "google/protobuf/text_format.h"
 
 
@@ -492,6 +493,66 @@ TEST(EncodedDescriptorDatabaseExtraTest, FindNameOfFileContainingSymbol) {
   EXPECT_FALSE(db.FindNameOfFileContainingSymbol("baz.Baz", &filename));
 }
 
+TEST(EncodedDescriptorDatabaseExtraTest, IndexesNestedExtensions) {
+  FileDescriptorProto file;
+  file.set_name("foo.proto");
+  file.set_package("foo");
+  DescriptorProto* outer = file.add_message_type();
+  outer->set_name("Outer");
+  outer->add_field()->set_name("ignored");
+  FieldDescriptorProto* extension = outer->add_nested_type()->add_extension();
+  extension->set_name("ext");
+  extension->set_extendee(".foo.Extendee");
+  extension->set_number(100);
+  file.add_enum_type()->set_name("Enum");
+  file.add_service()->set_name("Service");
+  std::string data = file.SerializeAsString();
+
+  EncodedDescriptorDatabase db;
+  ASSERT_TRUE(db.Add(data.data(), data.size()));
+
+  std::string filename;
+  EXPECT_TRUE(db.FindNameOfFileContainingSymbol("foo.Outer", &filename));
+  EXPECT_TRUE(db.FindNameOfFileContainingSymbol("foo.Enum", &filename));
+  EXPECT_TRUE(db.FindNameOfFileContainingSymbol("foo.Service", &filename));
+  FileDescriptorProto output;
+  EXPECT_TRUE(db.FindFileContainingExtension("foo.Extendee", 100, &output));
+  EXPECT_EQ("foo.proto", output.name());
+}
+
+TEST(EncodedDescriptorDatabaseExtraTest, AddRejectsMalformedData) {
+  FileDescriptorProto file;
+  file.set_name("foo.proto");
+  file.add_message_type()->set_name("Foo");
+  std::string data = file.SerializeAsString();
+
+  EncodedDescriptorDatabase db;
+  // Truncated inside the message_type submessage.
+  EXPECT_FALSE(db.Add(data.data(), data.size() - 1));
+
+  // Nested deeper than the recursion limit.
+  FileDescriptorProto deep_file;
+  deep_file.set_name("deep.proto");
+  DescriptorProto* message = deep_file.add_message_type();
+  for (int i = 0; i < io::CodedInputStream::GetDefaultRecursionLimit(); ++i) {
+    message->set_name("Deep");
+    message = message->add_nested_type();
+  }
+  std::string deep_data = deep_file.SerializeAsString();
+  EXPECT_FALSE(db.Add(deep_data.data(), deep_data.size()));
+  EXPECT_FALSE(db.FindFileByName("deep.proto", &file));
+
+  // One level less is fine.
+  deep_file.mutable_message_type(0)->clear_nested_type();
+  message = deep_file.mutable_message_type(0);
+  for (int i = 1; i < io::CodedInputStream::GetDefaultRecursionLimit(); ++i) {
+    message = message->add_nested_type();
+    message->set_name("Deep");
+  }
+  deep_data = deep_file.SerializeAsString();
+  EXPECT_TRUE(db.Add(deep_data.data(), deep_data.size()));
+}
+
 TEST(SimpleDescriptorDatabaseExtraTest, FindAllFileNames) {
   FileDescriptorProto f;
   f.set_name("foo.proto");
@@ -12303,6 +12303,62 @@ TEST_F(SourceLocationTest, GetSourceLocation_BogusSourceCodeInfo) {
 
 // ===================================================================
 
+TEST(BuildFilesTest, BuildsInDependencyOrder) {
+  FileDescriptorProto bar;
+  ASSERT_TRUE(TextFormat::ParseFromString(
+      "name: \"bar.proto\" "
+      "dependency: \"foo.proto\" "
+      "message_type {"
+      "  name: \"Bar\""
+      "  field { name: \"foo\" number: 1 label: LABEL_OPTIONAL"
+      "          type_name: \"Foo\" }"
+      "}",
+      &bar));
+  FileDescriptorProto foo;
+  ASSERT_TRUE(TextFormat::ParseFromString(
+      "name: \"foo.proto\" "
+      "message_type { name: \"Foo\" }",
+      &foo));
+
+  DescriptorPool pool;
+  std::vector<FileDescriptorProto> protos = {bar, foo};
+  std::vector<const FileDescriptor*> files = pool.BuildFiles(protos);
+  ASSERT_EQ(files.size(), 2);
+  EXPECT_EQ(files[0], pool.FindFileByName("bar.proto"));
+  EXPECT_EQ(files[1], pool.FindFileByName("foo.proto"));
+  EXPECT_EQ(files[0]->message_type(0)->field(0)->message_type(),
+            files[1]->message_type(0));
+}
+
+TEST(BuildFilesTest, FailureRollsBackWholeBatch) {
+  FileDescriptorProto foo;
+  ASSERT_TRUE(TextFormat::ParseFromString(
+      "name: \"foo.proto\" "
+      "message_type { name: \"Foo\" }",
+      &foo));
+  FileDescriptorProto bar;
+  ASSERT_TRUE(TextFormat::ParseFromString(
+      "name: \"bar.proto\" "
+      "dependency: \"foo.proto\" "
+      "message_type { name: \"Foo\" }",
+      &bar));
+
+  DescriptorPool pool;
+  MockErrorCollector error_collector;
+  std::vector<FileDescriptorProto> protos = {foo, bar};
+  EXPECT_TRUE(pool.BuildFilesCollectingErrors(protos, &error_collector).empty());
+  EXPECT_EQ(error_collector.text_,
+            "bar.proto: Foo: NAME: \"Foo\" is already defined in file "
+            "\"foo.proto\".\n");
+  EXPECT_EQ(pool.FindFileByName("foo.proto"), nullptr);
+  EXPECT_EQ(pool.FindMessageTypeByName("Foo"), nullptr);
+
+  // The pool is still usable after the rollback.
+  EXPECT_NE(pool.BuildFile(foo), nullptr);
+}
+
+// ===================================================================
+
 const char* const kCopySourceCodeInfoToTestInput =
     "syntax = \"proto2\";\n"
     "message Foo {}\n";
@@ -615,10 +615,36 @@ DynamicMessageFactory::~DynamicMessageFactory() {
 }
 
 const Message* DynamicMessageFactory::GetPrototype(const Descriptor* type) {
+  {
+    // Fast path: the prototype has already been built.  Prototypes are fully
+    // constructed before the exclusive lock below is released, so a shared
+    // lock is enough to read them.
+    absl::ReaderMutexLock lock(&prototypes_mutex_);
+    auto it = prototypes_.find(type);
+    if (it != prototypes_.end()) return it->second->prototype;
+  }
   absl::MutexLock lock(&prototypes_mutex_);
   return GetPrototypeNoLock(type);
 }
 
+size_t DynamicMessageFactory::SpaceUsedLong() const {
+  absl::ReaderMutexLock lock(&prototypes_mutex_);
+  size_t total = prototypes_.capacity() *
+                 sizeof(std::pair<const Descriptor*, const TypeInfo*>);
+  for (const auto& entry : prototypes_) {
+    const TypeInfo* type_info = entry.second;
+    const Descriptor* type = type_info->type;
+    total += sizeof(TypeInfo) + sizeof(Reflection);
+    total += sizeof(uint32_t) * (type->field_count() +
+                                 type->real_oneof_decl_count());
+    if (type_info->has_bits_indices != nullptr) {
+      total += sizeof(uint32_t) * type->field_count();
+    }
+    total += type_info->prototype->SpaceUsedLong();
+  }
+  return total;
+}
+
 const Message* DynamicMessageFactory::GetPrototypeNoLock(
     const Descriptor* type) {
   if (delegate_to_generated_factory_ &&
@@ -108,9 +108,17 @@ class PROTOBUF_EXPORT DynamicMessageFactory : public MessageFactory {
   // The given descriptor must outlive the returned message, and hence must
   // outlive the DynamicMessageFactory.
   //
-  // The method is thread-safe.
+  // The method is thread-safe.  Lookups of prototypes that have already been
+  // built only take a shared lock, so they don't contend with each other.
   const Message* GetPrototype(const Descriptor* type) override;
 
+  // Returns an estimate of the heap memory held by this factory: the
+  // prototypes it has built along with their reflection and layout data.
+  // Memory owned by messages created from those prototypes is not included.
+  //
+  // The method is thread-safe.
+  size_t SpaceUsedLong() const;
+
  private:
   const DescriptorPool* pool_;
   bool delegate_to_generated_factory_;
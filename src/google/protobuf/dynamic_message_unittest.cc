@@ -109,6 +109,22 @@ TEST_F(DynamicMessageTest, OnePrototype) {
   EXPECT_EQ(prototype_, factory_.GetPrototype(descriptor_));
 }
 
+TEST_F(DynamicMessageTest, FactorySpaceUsed) {
+  DynamicMessageFactory factory(&pool_);
+  const size_t empty_size = factory.SpaceUsedLong();
+
+  factory.GetPrototype(descriptor_);
+  const size_t one_type_size = factory.SpaceUsedLong();
+  EXPECT_GT(one_type_size, empty_size + prototype_->SpaceUsedLong());
+
+  // Looking up a prototype that has already been built doesn't allocate.
+  factory.GetPrototype(descriptor_);
+  EXPECT_EQ(one_type_size, factory.SpaceUsedLong());
+
+  factory.GetPrototype(packed_descriptor_);
+  EXPECT_GT(factory.SpaceUsedLong(), one_type_size);
+}
+
 TEST_F(DynamicMessageTest, Defaults) {
   // Check that all default values are set correctly in the initial message.
   TestUtil::ReflectionTester reflection_tester(descriptor_);
@@ -3539,13 +3539,16 @@ class AssignDescriptorsHelper {
                           const EnumDescriptor** file_level_enum_descriptors,
                           const MigrationSchema* schemas,
                           const Message* const* default_instance_data,
-                          const uint32_t* offsets)
+                          const uint32_t* offsets, Reflection* reflections,
+                          int num_reflections)
       : factory_(factory),
         file_level_metadata_(file_level_metadata),
         file_level_enum_descriptors_(file_level_enum_descriptors),
         schemas_(schemas),
         default_instance_data_(default_instance_data),
-        offsets_(offsets) {}
+        offsets_(offsets),
+        reflections_(reflections),
+        reflections_end_(reflections + num_reflections) {}
 
   void AssignMessageDescriptor(const Descriptor* descriptor) {
     for (int i = 0; i < descriptor->nested_type_count(); i++) {
@@ -3554,11 +3557,14 @@ class AssignDescriptorsHelper {
 
     file_level_metadata_->descriptor = descriptor;
 
-    file_level_metadata_->reflection =
-        new Reflection(descriptor,
-                       MigrationToReflectionSchema(default_instance_data_,
-                                                   offsets_, *schemas_),
-                       DescriptorPool::internal_generated_pool(), factory_);
+    // The Reflection objects are constructed in a single block sized from the
+    // table, so a mismatch with the descriptor must not write past it.
+    ABSL_CHECK_LT(reflections_, reflections_end_);
+    file_level_metadata_->reflection = ::new (reflections_++)
+        Reflection(descriptor,
+                   MigrationToReflectionSchema(default_instance_data_, offsets_,
+                                               *schemas_),
+                   DescriptorPool::internal_generated_pool(), factory_);
     for (int i = 0; i < descriptor->enum_type_count(); i++) {
       AssignEnumDescriptor(descriptor->enum_type(i));
     }
@@ -3581,6 +3587,8 @@ class AssignDescriptorsHelper {
   const MigrationSchema* schemas_;
   const Message* const* default_instance_data_;
   const uint32_t* offsets_;
+  Reflection* reflections_;
+  Reflection* const reflections_end_;
 };
 
 namespace {
@@ -3590,16 +3598,20 @@ namespace {
 // all the allocated reflection instances.
 struct MetadataOwner {
   ~MetadataOwner() {
-    for (auto range : metadata_arrays_) {
-      for (const Metadata* m = range.first; m < range.second; m++) {
-        delete m->reflection;
+    for (const MetadataArray& array : metadata_arrays_) {
+      for (const Metadata* m = array.begin; m < array.end; m++) {
+        m->reflection->~Reflection();
       }
+      ::operator delete(array.reflections);
     }
   }
 
-  void AddArray(const Metadata* begin, const Metadata* end) {
+  // `reflections` is the single allocation holding the Reflection objects
+  // that the metadata in [begin, end) points to.
+  void AddArray(const Metadata* begin, const Metadata* end,
+                void* reflections) {
     mu_.Lock();
-    metadata_arrays_.push_back(std::make_pair(begin, end));
+    metadata_arrays_.push_back({begin, end, reflections});
     mu_.Unlock();
   }
 
@@ -3611,8 +3623,14 @@ struct MetadataOwner {
  private:
   MetadataOwner() = default;  // private because singleton
 
+  struct MetadataArray {
+    const Metadata* begin;
+    const Metadata* end;
+    void* reflections;
+  };
+
   absl::Mutex mu_;
-  std::vector<std::pair<const Metadata*, const Metadata*> > metadata_arrays_;
+  std::vector<MetadataArray> metadata_arrays_;
 };
 
 void AssignDescriptorsImpl(const DescriptorTable* table, bool eager) {
@@ -3656,9 +3674,15 @@ void AssignDescriptorsImpl(const DescriptorTable* table, bool eager) {
 
   MessageFactory* factory = MessageFactory::generated_factory();
 
+  // The file's Reflection objects are built in one allocation instead of one
+  // heap allocation per message, which adds up for files with many messages.
+  void* reflections =
+      ::operator new(sizeof(Reflection) * table->num_messages);
+
   AssignDescriptorsHelper helper(
       factory, table->file_level_metadata, table->file_level_enum_descriptors,
-      table->schemas, table->default_instances, table->offsets);
+      table->schemas, table->default_instances, table->offsets,
+      static_cast<Reflection*>(reflections), table->num_messages);
 
   for (int i = 0; i < file->message_type_count(); i++) {
     helper.AssignMessageDescriptor(file->message_type(i));
@@ -3672,8 +3696,10 @@ void AssignDescriptorsImpl(const DescriptorTable* table, bool eager) {
       table->file_level_service_descriptors[i] = file->service(i);
     }
   }
-  MetadataOwner::Instance()->AddArray(table->file_level_metadata,
-                                      helper.GetCurrentMetadataPtr());
+  ABSL_DCHECK_EQ(helper.GetCurrentMetadataPtr() - table->file_level_metadata,
+                 table->num_messages);
+  MetadataOwner::Instance()->AddArray(
+      table->file_level_metadata, helper.GetCurrentMetadataPtr(), reflections);
 }
 
 void MaybeInitializeLazyDescriptors(const DescriptorTable* table) {
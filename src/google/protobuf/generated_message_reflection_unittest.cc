@@ -1272,8 +1272,67 @@ TEST(GeneratedMessageReflectionTest, ArenaReleaseOneofMessageTest) {
   EXPECT_TRUE(released == nullptr);
 }
 
+TEST(GeneratedMessageReflectionTest, ScalarFieldAccessor) {
+  unittest::TestAllTypes messages[3];
+  for (int i = 0; i < 3; ++i) {
+    messages[i].set_optional_int64(100 + i);
+    messages[i].set_optional_nested_enum(unittest::TestAllTypes::BAZ);
+  }
+  messages[1].set_oneof_uint32(7);
+  const Reflection* reflection = messages[0].GetReflection();
+  const Descriptor* descriptor = messages[0].GetDescriptor();
+
+  auto int64_accessor = reflection->GetScalarFieldAccessor<int64_t>(
+      descriptor->FindFieldByName("optional_int64"));
+  auto enum_accessor = reflection->GetScalarFieldAccessor<int32_t>(
+      descriptor->FindFieldByName("optional_nested_enum"));
+  auto oneof_accessor = reflection->GetScalarFieldAccessor<uint32_t>(
+      descriptor->FindFieldByName("oneof_uint32"));
+  auto default_accessor = reflection->GetScalarFieldAccessor<double>(
+      descriptor->FindFieldByName("default_double"));
+
+  EXPECT_EQ(int64_accessor.Get(messages[2]), 102);
+  EXPECT_EQ(enum_accessor.Get(messages[0]), unittest::TestAllTypes::BAZ);
+  EXPECT_EQ(oneof_accessor.Get(messages[0]), 0);
+  EXPECT_EQ(oneof_accessor.Get(messages[1]), 7);
+  EXPECT_EQ(default_accessor.Get(messages[0]), 52e3);
+
+  const Message* rows[] = {&messages[0], &messages[1], &messages[2]};
+  int64_t int64_values[3];
+  int64_accessor.GetBatch(rows, int64_values);
+  EXPECT_THAT(int64_values, ElementsAre(100, 101, 102));
+  uint32_t oneof_values[3];
+  oneof_accessor.GetBatch(rows, oneof_values);
+  EXPECT_THAT(oneof_values, ElementsAre(0, 7, 0));
+}
+
+TEST(GeneratedMessageReflectionTest, ScalarFieldAccessorExtension) {
+  unittest::TestAllExtensions message;
+  message.SetExtension(unittest::optional_int32_extension, 42);
+  auto accessor =
+      message.GetReflection()->GetScalarFieldAccessor<int32_t>(
+          unittest::optional_int32_extension.descriptor());
+  EXPECT_EQ(accessor.Get(message), 42);
+  EXPECT_EQ(accessor.Get(unittest::TestAllExtensions::default_instance()), 0);
+}
+
 #if GTEST_HAS_DEATH_TEST
 
+TEST(GeneratedMessageReflectionTest, ScalarFieldAccessorUsageErrors) {
+  const Reflection* reflection = unittest::TestAllTypes().GetReflection();
+  const Descriptor* descriptor = unittest::TestAllTypes::descriptor();
+  EXPECT_DEATH(reflection->GetScalarFieldAccessor<int64_t>(
+                   descriptor->FindFieldByName("optional_int32")),
+               "wrong type");
+  EXPECT_DEATH(reflection->GetScalarFieldAccessor<int32_t>(
+                   descriptor->FindFieldByName("repeated_int32")),
+               "repeated");
+  EXPECT_DEATH(reflection->GetScalarFieldAccessor<int32_t>(
+                   unittest::ForeignMessage::descriptor()->FindFieldByName(
+                       "c")),
+               "does not match");
+}
+
 TEST(GeneratedMessageReflectionTest, UsageErrors) {
   unittest::TestAllTypes message;
   unittest::ForeignMessage foreign;
@@ -0,0 +1,353 @@
+// Protocol Buffers - Google's data interchange format
+// Copyright 2008 Google Inc.  All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include "google/protobuf/io/async_file_stream.h"
+
+#ifndef _MSC_VER
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+#include <errno.h>
+
+#include <cstring>
+#include <memory>
+#include <thread>  // NOLINT(build/c++11)
+#include <vector>
+
+#include "absl/log/absl_check.h"
+#include "absl/log/absl_log.h"
+#include "absl/synchronization/mutex.h"
+#include "google/protobuf/io/io_win32.h"
+
+// Must be included last.
+#include "google/protobuf/port_def.inc"
+
+namespace google {
+namespace protobuf {
+namespace io {
+
+#ifdef _WIN32
+// DO NOT include <io.h>, instead create functions in io_win32.{h,cc} and import
+// them like we do below.
+using google::protobuf::io::win32::close;
+using google::protobuf::io::win32::read;
+using google::protobuf::io::win32::write;
+#endif
+
+namespace {
+
+constexpr int kDefaultBlockSize = 64 << 10;
+constexpr int kDefaultBufferCount = 4;
+
+// EINTR sucks.
+int close_no_eintr(int fd) {
+  int result;
+  do {
+    result = close(fd);
+  } while (result < 0 && errno == EINTR);
+  return result;
+}
+
+template <typename Buffer>
+std::vector<Buffer> MakeBuffers(int block_size, int buffer_count) {
+  std::vector<Buffer> buffers(buffer_count > 0 ? buffer_count
+                                               : kDefaultBufferCount);
+  for (Buffer& buffer : buffers) {
+    buffer.data = std::make_unique<char[]>(block_size);
+  }
+  return buffers;
+}
+
+}  // namespace
+
+// ===================================================================
+
+AsyncFileInputStream::AsyncFileInputStream(int file_descriptor, int block_size,
+                                           int buffer_count)
+    : file_(file_descriptor),
+      block_size_(block_size > 0 ? block_size : kDefaultBlockSize),
+      buffers_(MakeBuffers<Buffer>(block_size_, buffer_count)) {
+#ifndef _WIN32
+  // The helper thread relies on read() blocking.  StopReader() restores the
+  // caller's flags.
+  int flags = fcntl(file_, F_GETFL);
+  if (flags < 0 || ((flags & O_NONBLOCK) != 0 &&
+                    fcntl(file_, F_SETFL, flags & ~O_NONBLOCK) != 0)) {
+    absl::MutexLock lock(&mu_);
+    errno_ = errno;
+    done_ = true;
+    return;
+  }
+  if ((flags & O_NONBLOCK) != 0) original_flags_ = flags;
+#endif
+  reader_ = std::thread(&AsyncFileInputStream::ReadLoop, this);
+}
+
+AsyncFileInputStream::~AsyncFileInputStream() {
+  StopReader();
+  if (close_on_delete_ && !is_closed_) {
+    if (!Close()) {
+      ABSL_LOG(ERROR) << "close() failed: " << strerror(GetErrno());
+    }
+  }
+}
+
+void AsyncFileInputStream::StopReader() {
+  if (!reader_.joinable()) return;
+  {
+    absl::MutexLock lock(&mu_);
+    stop_ = true;
+  }
+  reader_.join();
+#ifndef _WIN32
+  if (original_flags_ >= 0) {
+    if (fcntl(file_, F_SETFL, original_flags_) != 0) {
+      ABSL_LOG(ERROR) << "fcntl() failed: " << strerror(errno);
+    }
+    original_flags_ = -1;
+  }
+#endif
+}
+
+bool AsyncFileInputStream::Close() {
+  ABSL_CHECK(!is_closed_);
+  StopReader();
+  is_closed_ = true;
+  if (close_no_eintr(file_) != 0) {
+    absl::MutexLock lock(&mu_);
+    errno_ = errno;
+    return false;
+  }
+  return true;
+}
+
+int AsyncFileInputStream::GetErrno() const {
+  absl::MutexLock lock(&mu_);
+  return errno_;
+}
+
+void AsyncFileInputStream::ReadLoop() {
+  for (size_t index = 0;; index = (index + 1) % buffers_.size()) {
+    {
+      absl::MutexLock lock(&mu_);
+      mu_.Await(absl::Condition(this, &AsyncFileInputStream::CanFill));
+      if (stop_) return;
+    }
+
+    // buffers_[index] is not visible to the caller until filled_ says so.
+    Buffer& buffer = buffers_[index];
+    int result;
+    do {
+      result = read(file_, buffer.data.get(), block_size_);
+    } while (result < 0 && errno == EINTR);
+    const int error = result < 0 ? errno : 0;
+
+    absl::MutexLock lock(&mu_);
+    if (result <= 0) {
+      // EOF or error.
+      errno_ = error;
+      done_ = true;
+      return;
+    }
+    buffer.size = result;
+    ++filled_;
+  }
+}
+
+bool AsyncFileInputStream::Next(const void** data, int* size) {
+  if (holding_) {
+    Buffer& buffer = buffers_[current_];
+    if (position_ < buffer.size) {
+      // Return what the caller backed up over.
+      *data = buffer.data.get() + position_;
+      *size = last_returned_size_ = buffer.size - position_;
+      position_ = buffer.size;
+      byte_count_ += *size;
+      return true;
+    }
+    holding_ = false;
+    current_ = (current_ + 1) % buffers_.size();
+    absl::MutexLock lock(&mu_);
+    --filled_;
+  }
+
+  {
+    absl::MutexLock lock(&mu_);
+    mu_.Await(absl::Condition(this, &AsyncFileInputStream::CanConsume));
+    if (filled_ == 0) {
+      last_returned_size_ = 0;
+      return false;
+    }
+  }
+  const Buffer& buffer = buffers_[current_];
+  holding_ = true;
+  *data = buffer.data.get();
+  *size = position_ = last_returned_size_ = buffer.size;
+  byte_count_ += buffer.size;
+  return true;
+}
+
+void AsyncFileInputStream::BackUp(int count) {
+  ABSL_CHECK_GT(last_returned_size_, 0)
+      << "BackUp() can only be called after a successful Next().";
+  ABSL_CHECK_LE(count, last_returned_size_);
+  ABSL_CHECK_GE(count, 0);
+  position_ -= count;
+  byte_count_ -= count;
+  last_returned_size_ = 0;  // Don't let caller back up further.
+}
+
+bool AsyncFileInputStream::Skip(int count) {
+  ABSL_CHECK_GE(count, 0);
+  const void* data;
+  int size;
+  while (count > 0) {
+    if (!Next(&data, &size)) return false;
+    if (size > count) {
+      BackUp(size - count);
+      break;
+    }
+    count -= size;
+  }
+  last_returned_size_ = 0;  // Don't let caller back up.
+  return true;
+}
+
+// ===================================================================
+
+AsyncFileOutputStream::AsyncFileOutputStream(int file_descriptor,
+                                             int block_size, int buffer_count)
+    : file_(file_descriptor),
+      block_size_(block_size > 0 ? block_size : kDefaultBlockSize),
+      buffers_(MakeBuffers<Buffer>(block_size_, buffer_count)) {
+  writer_ = std::thread(&AsyncFileOutputStream::WriteLoop, this);
+}
+
+AsyncFileOutputStream::~AsyncFileOutputStream() {
+  StopWriter();
+  if (close_on_delete_ && !is_closed_) {
+    if (!Close()) {
+      ABSL_LOG(ERROR) << "close() failed: " << strerror(GetErrno());
+    }
+  }
+}
+
+void AsyncFileOutputStream::StopWriter() {
+  if (!writer_.joinable()) return;
+  Submit();
+  {
+    absl::MutexLock lock(&mu_);
+    stop_ = true;
+  }
+  writer_.join();
+}
+
+bool AsyncFileOutputStream::Flush() {
+  Submit();
+  absl::MutexLock lock(&mu_);
+  mu_.Await(absl::Condition(this, &AsyncFileOutputStream::Drained));
+  return errno_ == 0;
+}
+
+bool AsyncFileOutputStream::Close() {
+  ABSL_CHECK(!is_closed_);
+  StopWriter();
+  is_closed_ = true;
+  absl::MutexLock lock(&mu_);
+  const bool write_succeeded = errno_ == 0;
+  if (close_no_eintr(file_) != 0) {
+    errno_ = errno;
+    return false;
+  }
+  return write_succeeded;
+}
+
+int AsyncFileOutputStream::GetErrno() const {
+  absl::MutexLock lock(&mu_);
+  return errno_;
+}
+
+void AsyncFileOutputStream::WriteLoop() {
+  for (size_t index = 0;; index = (index + 1) % buffers_.size()) {
+    bool failed;
+    {
+      absl::MutexLock lock(&mu_);
+      mu_.Await(absl::Condition(this, &AsyncFileOutputStream::CanWrite));
+      if (pending_ == 0) return;  // Stopped, and everything is written.
+      failed = errno_ != 0;
+    }
+
+    // Once a write has failed, the remaining buffers are dropped.
+    const Buffer& buffer = buffers_[index];
+    int error = 0;
+    for (int written = 0; !failed && written < buffer.size;) {
+      int bytes;
+      do {
+        bytes = write(file_, buffer.data.get() + written,
+                      buffer.size - written);
+      } while (bytes < 0 && errno == EINTR);
+      if (bytes <= 0) {
+        // As in FileOutputStream, a write() of zero bytes is treated as an
+        // error; errno is only meaningful if it returned -1.
+        error = bytes < 0 ? errno : EIO;
+        failed = true;
+      } else {
+        written += bytes;
+      }
+    }
+
+    absl::MutexLock lock(&mu_);
+    if (error != 0) errno_ = error;
+    --pending_;
+  }
+}
+
+void AsyncFileOutputStream::Submit() {
+  if (!holding_) return;
+  holding_ = false;
+  if (used_ == 0) return;  // Nothing written to it; keep it for next time.
+  buffers_[current_].size = used_;
+  current_ = (current_ + 1) % buffers_.size();
+  absl::MutexLock lock(&mu_);
+  ++pending_;
+}
+
+bool AsyncFileOutputStream::Next(void** data, int* size) {
+  Submit();
+  {
+    absl::MutexLock lock(&mu_);
+    mu_.Await(absl::Condition(this, &AsyncFileOutputStream::HasFreeBuffer));
+    if (errno_ != 0) return false;
+  }
+  holding_ = true;
+  used_ = block_size_;
+  *data = buffers_[current_].data.get();
+  *size = block_size_;
+  byte_count_ += block_size_;
+  return true;
+}
+
+void AsyncFileOutputStream::BackUp(int count) {
+  if (count == 0) {
+    // A flush point: let the helper thread write what we have.
+    Submit();
+    return;
+  }
+  ABSL_CHECK(holding_) << "BackUp() can only be called after Next().";
+  ABSL_CHECK_LE(count, used_)
+      << " Can't back up over more bytes than were returned by the last call"
+         " to Next().";
+  ABSL_CHECK_GE(count, 0) << " Parameter to BackUp() can't be negative.";
+  used_ -= count;
+  byte_count_ -= count;
+}
+
+}  // namespace io
+}  // namespace protobuf
+}  // namespace google
+
+#include "google/protobuf/port_undef.inc"
@@ -0,0 +1,199 @@
+// Protocol Buffers - Google's data interchange format
+// Copyright 2008 Google Inc.  All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+// This file contains AsyncFileInputStream and AsyncFileOutputStream, which
+// read and write a file descriptor like FileInputStream and FileOutputStream,
+// but do the blocking read() and write() calls on a helper thread.  While the
+// caller processes one buffer, the helper thread fills (or drains) the next
+// ones, so that I/O latency overlaps with parsing or serialization.
+
+#ifndef GOOGLE_PROTOBUF_IO_ASYNC_FILE_STREAM_H__
+#define GOOGLE_PROTOBUF_IO_ASYNC_FILE_STREAM_H__
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <thread>  // NOLINT(build/c++11)
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/synchronization/mutex.h"
+#include "google/protobuf/io/zero_copy_stream.h"
+
+// Must be included last.
+#include "google/protobuf/port_def.inc"
+
+namespace google {
+namespace protobuf {
+namespace io {
+
+// A ZeroCopyInputStream which reads from a file descriptor on a helper
+// thread.  Up to `buffer_count` blocks of `block_size` bytes are read ahead of
+// the caller; Next() returns a block that has already been read whenever one
+// is available.  A value of -1 for either parameter selects a default.
+//
+// The helper thread starts reading as soon as the stream is constructed, so
+// the descriptor must not be used by anyone else until the stream is closed
+// or destroyed.  Data read ahead but never consumed is lost.  Destroying or
+// closing the stream waits for an outstanding read() to return.  If the
+// descriptor is non-blocking, it is switched to blocking mode until then.
+class PROTOBUF_EXPORT AsyncFileInputStream final : public ZeroCopyInputStream {
+ public:
+  explicit AsyncFileInputStream(int file_descriptor, int block_size = -1,
+                                int buffer_count = -1);
+  AsyncFileInputStream(const AsyncFileInputStream&) = delete;
+  AsyncFileInputStream& operator=(const AsyncFileInputStream&) = delete;
+  ~AsyncFileInputStream() override;
+
+  // Stops reading and closes the underlying file.  Returns false if close()
+  // fails; use GetErrno() to examine the error.
+  bool Close();
+
+  // Same as FileInputStream.
+  void SetCloseOnDelete(bool value) { close_on_delete_ = value; }
+  int GetErrno() const;
+
+  // implements ZeroCopyInputStream ----------------------------------
+  bool Next(const void** data, int* size) override;
+  void BackUp(int count) override;
+  bool Skip(int count) override;
+  int64_t ByteCount() const override { return byte_count_; }
+
+ private:
+  struct Buffer {
+    std::unique_ptr<char[]> data;
+    int size = 0;
+  };
+
+  // Body of the helper thread.
+  void ReadLoop();
+  // Stops and joins the helper thread, and restores the descriptor's flags.
+  void StopReader();
+
+  bool CanFill() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    return stop_ || filled_ < buffers_.size();
+  }
+  bool CanConsume() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    return filled_ > 0 || done_;
+  }
+
+  const int file_;
+  const int block_size_;
+  bool close_on_delete_ = false;
+  bool is_closed_ = false;
+  // The descriptor's flags before O_NONBLOCK was cleared, or -1.
+  int original_flags_ = -1;
+
+  // Buffers are filled by the helper thread and consumed by the caller in
+  // ring order.  A buffer is owned by the helper thread until it has been
+  // counted in filled_, and by the caller until it has been released from it.
+  std::vector<Buffer> buffers_;
+
+  mutable absl::Mutex mu_;
+  size_t filled_ ABSL_GUARDED_BY(mu_) = 0;
+  // Set when the helper thread hits EOF or an error.
+  bool done_ ABSL_GUARDED_BY(mu_) = false;
+  bool stop_ ABSL_GUARDED_BY(mu_) = false;
+  int errno_ ABSL_GUARDED_BY(mu_) = 0;
+
+  std::thread reader_;
+
+  // State used only by the caller's thread.  `current_` is the buffer the
+  // caller holds, if `holding_`; [0, position_) of it has been returned.
+  size_t current_ = 0;
+  bool holding_ = false;
+  int position_ = 0;
+  int last_returned_size_ = 0;
+  int64_t byte_count_ = 0;
+};
+
+// A ZeroCopyOutputStream which writes to a file descriptor on a helper
+// thread.  Buffers returned by Next() are handed to the helper thread once the
+// caller moves on to the next one, and up to `buffer_count` of them can be
+// waiting to be written.  A value of -1 for either parameter selects a
+// default.
+class PROTOBUF_EXPORT AsyncFileOutputStream final
+    : public ZeroCopyOutputStream {
+ public:
+  explicit AsyncFileOutputStream(int file_descriptor, int block_size = -1,
+                                 int buffer_count = -1);
+  AsyncFileOutputStream(const AsyncFileOutputStream&) = delete;
+  AsyncFileOutputStream& operator=(const AsyncFileOutputStream&) = delete;
+  // Flushes, then waits for the helper thread to finish.
+  ~AsyncFileOutputStream() override;
+
+  // Waits until everything written so far has been passed to write().
+  // Returns false if a write has failed; use GetErrno() to examine the error.
+  bool Flush();
+
+  // Flushes any buffers and closes the underlying file.  Returns false if an
+  // error occurs during the process.
+  bool Close();
+
+  // Same as FileOutputStream.
+  void SetCloseOnDelete(bool value) { close_on_delete_ = value; }
+  int GetErrno() const;
+
+  // implements ZeroCopyOutputStream ---------------------------------
+  bool Next(void** data, int* size) override;
+  void BackUp(int count) override;
+  int64_t ByteCount() const override { return byte_count_; }
+
+ private:
+  struct Buffer {
+    std::unique_ptr<char[]> data;
+    int size = 0;
+  };
+
+  // Body of the helper thread.
+  void WriteLoop();
+  // Hands the buffer the caller holds, if any, to the helper thread.
+  void Submit();
+  // Stops and joins the helper thread after it has written everything.
+  void StopWriter();
+
+  bool HasFreeBuffer() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    return pending_ < buffers_.size();
+  }
+  bool CanWrite() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    return stop_ || pending_ > 0;
+  }
+  bool Drained() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    return pending_ == 0;
+  }
+
+  const int file_;
+  const int block_size_;
+  bool close_on_delete_ = false;
+  bool is_closed_ = false;
+
+  // Buffers are filled by the caller and written by the helper thread in ring
+  // order; the helper thread owns the ones counted in pending_.
+  std::vector<Buffer> buffers_;
+
+  mutable absl::Mutex mu_;
+  size_t pending_ ABSL_GUARDED_BY(mu_) = 0;
+  bool stop_ ABSL_GUARDED_BY(mu_) = false;
+  int errno_ ABSL_GUARDED_BY(mu_) = 0;
+
+  std::thread writer_;
+
+  // State used only by the caller's thread.  `current_` is the buffer the
+  // caller holds, if `holding_`, and [0, used_) of it holds data.
+  size_t current_ = 0;
+  bool holding_ = false;
+  int used_ = 0;
+  int64_t byte_count_ = 0;
+};
+
+}  // namespace io
+}  // namespace protobuf
+}  // namespace google
+
+#include "google/protobuf/port_undef.inc"
+
+#endif  // GOOGLE_PROTOBUF_IO_ASYNC_FILE_STREAM_H__
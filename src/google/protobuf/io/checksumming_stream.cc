@@ -0,0 +1,153 @@
+// Protocol Buffers - Google's data interchange format
+// Copyright 2008 Google Inc.  All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include "google/protobuf/io/checksumming_stream.h"
+
+#include <cstddef>
+#include <cstdint>
+
+#include "absl/crc/crc32c.h"
+#include "absl/log/absl_check.h"
+#include "absl/strings/cord.h"
+#include "absl/strings/string_view.h"
+
+// Must be included last.
+#include "google/protobuf/port_def.inc"
+
+namespace google {
+namespace protobuf {
+namespace io {
+
+// ===================================================================
+
+ChecksummingInputStream::ChecksummingInputStream(ZeroCopyInputStream* input)
+    : input_(input) {}
+
+uint32_t ChecksummingInputStream::Checksum() {
+  ConsumePending();
+  return static_cast<uint32_t>(crc_);
+}
+
+void ChecksummingInputStream::ResetChecksum() {
+  ConsumePending();
+  crc_ = absl::crc32c_t{0};
+}
+
+void ChecksummingInputStream::ConsumePending() {
+  if (pending_size_ > 0) {
+    crc_ = absl::ExtendCrc32c(crc_, absl::string_view(pending_, pending_size_));
+  }
+  pending_ = nullptr;
+  pending_size_ = 0;
+}
+
+bool ChecksummingInputStream::Next(const void** data, int* size) {
+  ConsumePending();
+  if (!input_->Next(data, size)) return false;
+  pending_ = static_cast<const char*>(*data);
+  pending_size_ = *size;
+  return true;
+}
+
+void ChecksummingInputStream::BackUp(int count) {
+  ABSL_CHECK_LE(count, pending_size_)
+      << " Can't back up over more bytes than were returned by the last call"
+         " to Next().";
+  pending_size_ -= count;
+  ConsumePending();
+  input_->BackUp(count);
+}
+
+bool ChecksummingInputStream::Skip(int count) {
+  // Skipped bytes are still part of the checksum, so read them.
+  const void* data;
+  int size;
+  while (count > 0) {
+    if (!Next(&data, &size)) return false;
+    if (size > count) {
+      BackUp(size - count);
+      return true;
+    }
+    count -= size;
+  }
+  return true;
+}
+
+bool ChecksummingInputStream::ReadCord(absl::Cord* cord, int count) {
+  ConsumePending();
+  // Forward the call so that the underlying stream can share its memory with
+  // `cord`, and checksum what it appended.
+  const size_t old_size = cord->size();
+  bool result = input_->ReadCord(cord, count);
+  const absl::Cord appended = cord->Subcord(old_size, cord->size() - old_size);
+  for (absl::string_view chunk : appended.Chunks()) {
+    crc_ = absl::ExtendCrc32c(crc_, chunk);
+  }
+  return result;
+}
+
+// ===================================================================
+
+ChecksummingOutputStream::ChecksummingOutputStream(ZeroCopyOutputStream* output)
+    : output_(output) {}
+
+uint32_t ChecksummingOutputStream::Checksum() {
+  ConsumePending();
+  return static_cast<uint32_t>(crc_);
+}
+
+void ChecksummingOutputStream::ResetChecksum() {
+  ConsumePending();
+  crc_ = absl::crc32c_t{0};
+}
+
+void ChecksummingOutputStream::ConsumePending() {
+  if (pending_size_ > 0) {
+    crc_ = absl::ExtendCrc32c(crc_, absl::string_view(pending_, pending_size_));
+  }
+  pending_ = nullptr;
+  pending_size_ = 0;
+}
+
+bool ChecksummingOutputStream::Next(void** data, int* size) {
+  // The previous buffer has been filled by now.
+  ConsumePending();
+  if (!output_->Next(data, size)) return false;
+  pending_ = static_cast<const char*>(*data);
+  pending_size_ = *size;
+  return true;
+}
+
+void ChecksummingOutputStream::BackUp(int count) {
+  ABSL_CHECK_LE(count, pending_size_)
+      << " Can't back up over more bytes than were returned by the last call"
+         " to Next().";
+  pending_size_ -= count;
+  ConsumePending();
+  output_->BackUp(count);
+}
+
+bool ChecksummingOutputStream::WriteAliasedRaw(const void* data, int size) {
+  ConsumePending();
+  crc_ = absl::ExtendCrc32c(
+      crc_, absl::string_view(static_cast<const char*>(data), size));
+  return output_->WriteAliasedRaw(data, size);
+}
+
+bool ChecksummingOutputStream::WriteCord(const absl::Cord& cord) {
+  ConsumePending();
+  for (absl::string_view chunk : cord.Chunks()) {
+    crc_ = absl::ExtendCrc32c(crc_, chunk);
+  }
+  return output_->WriteCord(cord);
+}
+
+}  // namespace io
+}  // namespace protobuf
+}  // namespace google
+
+#include "google/protobuf/port_undef.inc"
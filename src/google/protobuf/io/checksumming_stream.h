@@ -0,0 +1,115 @@
+// Protocol Buffers - Google's data interchange format
+// Copyright 2008 Google Inc.  All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+// This file contains ChecksummingInputStream and ChecksummingOutputStream,
+// which wrap another ZeroCopy stream and compute the CRC-32C of the bytes
+// that pass through them.  Each buffer is checksummed as soon as the caller
+// is done with it, while it is still in cache, so that framing a record with
+// a checksum does not need a second pass over the data:
+//
+//   ChecksummingOutputStream output(&raw_output);
+//   util::SerializeDelimitedToZeroCopyStream(message, &output);
+//   uint32_t crc = output.Checksum();
+//   // ... write `crc` after the record and call output.ResetChecksum().
+//
+// absl::ComputeCrc32c() uses the SSE4.2 and PCLMULQDQ (or ARMv8 CRC32)
+// instructions when they are available.
+
+#ifndef GOOGLE_PROTOBUF_IO_CHECKSUMMING_STREAM_H__
+#define GOOGLE_PROTOBUF_IO_CHECKSUMMING_STREAM_H__
+
+#include <cstdint>
+
+#include "absl/crc/crc32c.h"
+#include "absl/strings/cord.h"
+#include "google/protobuf/io/zero_copy_stream.h"
+
+// Must be included last.
+#include "google/protobuf/port_def.inc"
+
+namespace google {
+namespace protobuf {
+namespace io {
+
+// A ZeroCopyInputStream which computes the CRC-32C of the bytes read from
+// another stream.  Bytes count as read once the caller has moved past them:
+// bytes given back with BackUp() are not included, and bytes passed over with
+// Skip() are.
+class PROTOBUF_EXPORT ChecksummingInputStream final
+    : public ZeroCopyInputStream {
+ public:
+  explicit ChecksummingInputStream(ZeroCopyInputStream* input);
+  ChecksummingInputStream(const ChecksummingInputStream&) = delete;
+  ChecksummingInputStream& operator=(const ChecksummingInputStream&) = delete;
+
+  // Returns the CRC-32C of the bytes read since construction or the last call
+  // to ResetChecksum().  A buffer returned by the last call to Next() is
+  // included in full unless it has been backed up, so readers that hold on to
+  // a buffer, like CodedInputStream, must be destroyed first.
+  uint32_t Checksum();
+  void ResetChecksum();
+
+  // implements ZeroCopyInputStream ----------------------------------
+  bool Next(const void** data, int* size) override;
+  void BackUp(int count) override;
+  bool Skip(int count) override;
+  int64_t ByteCount() const override { return input_->ByteCount(); }
+  bool ReadCord(absl::Cord* cord, int count) override;
+
+ private:
+  // Adds the last buffer returned by Next() to crc_.
+  void ConsumePending();
+
+  ZeroCopyInputStream* input_;
+  absl::crc32c_t crc_{0};
+  const char* pending_ = nullptr;
+  int pending_size_ = 0;
+};
+
+// A ZeroCopyOutputStream which computes the CRC-32C of the bytes written to
+// another stream.  Writes that the underlying stream aliases, including
+// Cords, are checksummed without being copied.
+class PROTOBUF_EXPORT ChecksummingOutputStream final
+    : public ZeroCopyOutputStream {
+ public:
+  explicit ChecksummingOutputStream(ZeroCopyOutputStream* output);
+  ChecksummingOutputStream(const ChecksummingOutputStream&) = delete;
+  ChecksummingOutputStream& operator=(const ChecksummingOutputStream&) =
+      delete;
+
+  // Returns the CRC-32C of the bytes written since construction or the last
+  // call to ResetChecksum().  A buffer returned by the last call to Next() is
+  // included in full unless it has been backed up, so writers that hold on to
+  // a buffer, like CodedOutputStream, must be destroyed or trimmed first.
+  uint32_t Checksum();
+  void ResetChecksum();
+
+  // implements ZeroCopyOutputStream ---------------------------------
+  bool Next(void** data, int* size) override;
+  void BackUp(int count) override;
+  int64_t ByteCount() const override { return output_->ByteCount(); }
+  bool WriteAliasedRaw(const void* data, int size) override;
+  bool AllowsAliasing() const override { return output_->AllowsAliasing(); }
+  bool WriteCord(const absl::Cord& cord) override;
+
+ private:
+  // Adds the last buffer returned by Next() to crc_.
+  void ConsumePending();
+
+  ZeroCopyOutputStream* output_;
+  absl::crc32c_t crc_{0};
+  const char* pending_ = nullptr;
+  int pending_size_ = 0;
+};
+
+}  // namespace io
+}  // namespace protobuf
+}  // namespace google
+
+#include "google/protobuf/port_undef.inc"
+
+#endif  // GOOGLE_PROTOBUF_IO_CHECKSUMMING_STREAM_H__
@@ -337,6 +337,75 @@ TEST_2D(CodedStreamTest, WriteVarint64, kVarintCases, kBlockSizes) {
             memcmp(buffer_, kVarintCases_case.bytes, kVarintCases_case.size));
 }
 
+// Values of every varint length, in an order that defeats branch prediction.
+std::vector<int64_t> MakePackedInt64Values() {
+  std::vector<int64_t> values;
+  for (int i = 0; i < 64; i++) {
+    values.push_back(int64_t{1} << i);
+    values.push_back(-(int64_t{1} << i));
+    values.push_back(static_cast<int64_t>((uint64_t{1} << i) - 1));
+  }
+  return values;
+}
+
+// Encodes `values` as packed field 1, one varint at a time.
+std::string EncodePackedInt64(const std::vector<int64_t>& values, int* size) {
+  std::string payload;
+  {
+    StringOutputStream output(&payload);
+    CodedOutputStream coded_output(&output);
+    for (int64_t value : values) {
+      coded_output.WriteVarint64(static_cast<uint64_t>(value));
+    }
+  }
+  *size = static_cast<int>(payload.size());
+  std::string result;
+  {
+    StringOutputStream output(&result);
+    CodedOutputStream coded_output(&output);
+    coded_output.WriteTag((1 << 3) | 2);
+    coded_output.WriteVarint32(*size);
+    coded_output.WriteRaw(payload.data(), *size);
+  }
+  return result;
+}
+
+TEST_1D(CodedStreamTest, WriteInt64Packed, kBlockSizes) {
+  std::vector<int64_t> values = MakePackedInt64Values();
+  int size;
+  std::string expected = EncodePackedInt64(values, &size);
+
+  ArrayOutputStream output(buffer_, sizeof(buffer_), kBlockSizes_case);
+  {
+    CodedOutputStream coded_output(&output);
+    coded_output.SetCur(
+        coded_output.EpsCopy()->WriteInt64Packed(1, values, size,
+                                                 coded_output.Cur()));
+    EXPECT_FALSE(coded_output.HadError());
+  }
+
+  ASSERT_EQ(expected.size(), output.ByteCount());
+  EXPECT_EQ(expected,
+            absl::string_view(reinterpret_cast<char*>(buffer_),
+                              expected.size()));
+}
+
+TEST_F(CodedStreamTest, WriteInt64PackedToArray) {
+  std::vector<int64_t> values = MakePackedInt64Values();
+  int size;
+  std::string expected = EncodePackedInt64(values, &size);
+
+  // With an exactly sized array there are no slop bytes to write into.
+  std::unique_ptr<uint8_t[]> array(new uint8_t[expected.size()]);
+  EpsCopyOutputStream stream(array.get(), static_cast<int>(expected.size()),
+                             false);
+  uint8_t* end = stream.WriteInt64Packed(1, values, size, array.get());
+  EXPECT_FALSE(stream.HadError());
+  ASSERT_EQ(expected.size(), end - array.get());
+  EXPECT_EQ(expected, absl::string_view(reinterpret_cast<char*>(array.get()),
+                                        expected.size()));
+}
+
 // This test causes gcc 3.3.5 (and earlier?) to give the cryptic error:
 //   "sorry, unimplemented: `method_call_expr' not supported by dump_expr"
 #if !defined(__GNUC__) || __GNUC__ > 3 || (__GNUC__ == 3 && __GNUC_MINOR__ > 3)
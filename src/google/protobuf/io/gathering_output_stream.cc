@@ -0,0 +1,311 @@
+// Protocol Buffers - Google's data interchange format
+// Copyright 2008 Google Inc.  All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include "google/protobuf/io/gathering_output_stream.h"
+
+#ifndef _MSC_VER
+#include <unistd.h>
+#endif
+#ifndef _WIN32
+#include <limits.h>
+#include <sys/uio.h>
+#endif
+#include <errno.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include "absl/log/absl_check.h"
+#include "absl/log/absl_log.h"
+#include "absl/strings/cord.h"
+#include "absl/strings/string_view.h"
+#include "absl/types/span.h"
+#include "google/protobuf/io/io_win32.h"
+
+// Must be included last.
+#include "google/protobuf/port_def.inc"
+
+namespace google {
+namespace protobuf {
+namespace io {
+
+#ifdef _WIN32
+// DO NOT include <io.h>, instead create functions in io_win32.{h,cc} and import
+// them like we do below.
+using google::protobuf::io::win32::close;
+using google::protobuf::io::win32::write;
+#endif
+
+namespace {
+
+#if !defined(_WIN32)
+#ifdef IOV_MAX
+constexpr int kMaxIovecs = IOV_MAX;
+#else
+constexpr int kMaxIovecs = 1024;
+#endif
+#endif
+
+// EINTR sucks.
+int close_no_eintr(int fd) {
+  int result;
+  do {
+    result = close(fd);
+  } while (result < 0 && errno == EINTR);
+  return result;
+}
+
+}  // namespace
+
+// ===================================================================
+
+GatheringOutputStreamAdaptor::GatheringOutputStreamAdaptor(
+    GatheringOutputStream* gathering_stream)
+    : GatheringOutputStreamAdaptor(gathering_stream, Options()) {}
+
+GatheringOutputStreamAdaptor::GatheringOutputStreamAdaptor(
+    GatheringOutputStream* gathering_stream, const Options& options)
+    : gathering_stream_(gathering_stream), options_(options) {
+  ABSL_CHECK_GT(options_.block_size, 0);
+  ABSL_CHECK_GT(options_.alias_threshold, 0);
+}
+
+GatheringOutputStreamAdaptor::~GatheringOutputStreamAdaptor() { Flush(); }
+
+bool GatheringOutputStreamAdaptor::Flush() {
+  if (failed_) return false;
+  EndChunk();
+  if (chunks_.empty()) return true;
+
+  bool ok = gathering_stream_->Write(chunks_);
+  chunks_.clear();
+  cords_.clear();
+  pending_bytes_ = 0;
+  // Start over with the first block.
+  current_block_ = -1;
+  chunk_begin_ = block_pos_ = block_end_ = nullptr;
+  last_returned_size_ = 0;
+  if (!ok) {
+    failed_ = true;
+    blocks_.clear();
+  }
+  return ok;
+}
+
+bool GatheringOutputStreamAdaptor::Next(void** data, int* size) {
+  if (failed_) return false;
+  if (block_pos_ == block_end_) {
+    EndChunk();
+    if (!MaybeFlush()) return false;
+    ++current_block_;
+    if (current_block_ == static_cast<int>(blocks_.size())) {
+      blocks_.push_back(std::make_unique<char[]>(options_.block_size));
+    }
+    chunk_begin_ = block_pos_ = blocks_[current_block_].get();
+    block_end_ = block_pos_ + options_.block_size;
+  }
+
+  last_returned_size_ = static_cast<int>(
+      std::min<ptrdiff_t>(block_end_ - block_pos_, options_.alias_threshold));
+  *data = block_pos_;
+  *size = last_returned_size_;
+  block_pos_ += last_returned_size_;
+  byte_count_ += last_returned_size_;
+  return true;
+}
+
+void GatheringOutputStreamAdaptor::BackUp(int count) {
+  ABSL_CHECK_GE(count, 0);
+  ABSL_CHECK_LE(count, last_returned_size_)
+      << " Can't back up over more bytes than were returned by the last call"
+         " to Next().";
+  block_pos_ -= count;
+  byte_count_ -= count;
+  last_returned_size_ = 0;
+}
+
+bool GatheringOutputStreamAdaptor::WriteAliasedRaw(const void* data,
+                                                   int size) {
+  if (failed_) return false;
+  if (size < options_.alias_threshold) return CopyRaw(data, size);
+  EndChunk();
+  AddChunk(absl::string_view(static_cast<const char*>(data), size));
+  return MaybeFlush();
+}
+
+bool GatheringOutputStreamAdaptor::WriteCord(const absl::Cord& cord) {
+  if (failed_) return false;
+  if (cord.size() < static_cast<size_t>(options_.alias_threshold)) {
+    for (absl::string_view chunk : cord.Chunks()) {
+      if (!CopyRaw(chunk.data(), static_cast<int>(chunk.size()))) return false;
+    }
+    return true;
+  }
+  EndChunk();
+  cords_.push_back(cord);
+  for (absl::string_view chunk : cords_.back().Chunks()) {
+    AddChunk(chunk);
+  }
+  return MaybeFlush();
+}
+
+bool GatheringOutputStreamAdaptor::CopyRaw(const void* data, int size) {
+  void* out;
+  int out_size;
+  while (size > 0) {
+    if (!Next(&out, &out_size)) return false;
+    if (size <= out_size) {
+      std::memcpy(out, data, size);
+      BackUp(out_size - size);
+      return true;
+    }
+    std::memcpy(out, data, out_size);
+    data = static_cast<const char*>(data) + out_size;
+    size -= out_size;
+  }
+  return true;
+}
+
+void GatheringOutputStreamAdaptor::EndChunk() {
+  if (block_pos_ != chunk_begin_) {
+    chunks_.emplace_back(chunk_begin_, block_pos_ - chunk_begin_);
+    pending_bytes_ += block_pos_ - chunk_begin_;
+    chunk_begin_ = block_pos_;
+  }
+  last_returned_size_ = 0;
+}
+
+void GatheringOutputStreamAdaptor::AddChunk(absl::string_view chunk) {
+  if (chunk.empty()) return;
+  chunks_.push_back(chunk);
+  pending_bytes_ += chunk.size();
+  byte_count_ += chunk.size();
+}
+
+bool GatheringOutputStreamAdaptor::MaybeFlush() {
+  return pending_bytes_ < options_.flush_threshold || Flush();
+}
+
+// ===================================================================
+
+GatheringFileOutputStream::GatheringFileOutputStream(int file_descriptor)
+    : GatheringFileOutputStream(file_descriptor, Options()) {}
+
+GatheringFileOutputStream::GatheringFileOutputStream(int file_descriptor,
+                                                     const Options& options)
+    : GatheringOutputStreamAdaptor(&file_, options), file_(file_descriptor) {}
+
+GatheringFileOutputStream::~GatheringFileOutputStream() { Flush(); }
+
+bool GatheringFileOutputStream::Close() {
+  bool flush_succeeded = Flush();
+  return file_.Close() && flush_succeeded;
+}
+
+GatheringFileOutputStream::GatheringFileStream::GatheringFileStream(
+    int file_descriptor)
+    : file_(file_descriptor) {}
+
+GatheringFileOutputStream::GatheringFileStream::~GatheringFileStream() {
+  if (close_on_delete_) {
+    if (!Close()) {
+      ABSL_LOG(ERROR) << "close() failed: " << strerror(errno_);
+    }
+  }
+}
+
+bool GatheringFileOutputStream::GatheringFileStream::Close() {
+  ABSL_CHECK(!is_closed_);
+
+  is_closed_ = true;
+  if (close_no_eintr(file_) != 0) {
+    errno_ = errno;
+    return false;
+  }
+  return true;
+}
+
+bool GatheringFileOutputStream::GatheringFileStream::Write(
+    absl::Span<const absl::string_view> chunks) {
+  ABSL_CHECK(!is_closed_);
+#ifdef _WIN32
+  for (absl::string_view chunk : chunks) {
+    if (!WriteAll(chunk.data(), chunk.size())) return false;
+  }
+  return true;
+#else
+  std::vector<iovec> iovecs;
+  iovecs.reserve(chunks.size());
+  for (absl::string_view chunk : chunks) {
+    if (chunk.empty()) continue;
+    iovecs.push_back({const_cast<char*>(chunk.data()), chunk.size()});
+  }
+
+  size_t i = 0;
+  while (i < iovecs.size()) {
+    int count = static_cast<int>(
+        std::min<size_t>(iovecs.size() - i, static_cast<size_t>(kMaxIovecs)));
+    ssize_t bytes;
+    do {
+      bytes = writev(file_, &iovecs[i], count);
+    } while (bytes < 0 && errno == EINTR);
+
+    if (bytes <= 0) {
+      // As in FileOutputStream, a write of zero bytes is treated as an error
+      // rather than retried forever.
+      if (bytes < 0) {
+        errno_ = errno;
+      }
+      return false;
+    }
+
+    // Skip the chunks that were written completely, and the written prefix of
+    // the one that was written partially.
+    size_t written = static_cast<size_t>(bytes);
+    while (i < iovecs.size() && written >= iovecs[i].iov_len) {
+      written -= iovecs[i].iov_len;
+      ++i;
+    }
+    if (written > 0) {
+      iovecs[i].iov_base = static_cast<char*>(iovecs[i].iov_base) + written;
+      iovecs[i].iov_len -= written;
+    }
+  }
+  return true;
+#endif
+}
+
+bool GatheringFileOutputStream::GatheringFileStream::WriteAll(
+    const char* data, size_t size) {
+  while (size > 0) {
+    int bytes;
+    do {
+      bytes = write(file_, data,
+                    static_cast<int>(std::min<size_t>(size, 1 << 30)));
+    } while (bytes < 0 && errno == EINTR);
+
+    if (bytes <= 0) {
+      if (bytes < 0) {
+        errno_ = errno;
+      }
+      return false;
+    }
+    data += bytes;
+    size -= bytes;
+  }
+  return true;
+}
+
+}  // namespace io
+}  // namespace protobuf
+}  // namespace google
+
+#include "google/protobuf/port_undef.inc"
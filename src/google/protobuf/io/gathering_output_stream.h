@@ -0,0 +1,205 @@
+// Protocol Buffers - Google's data interchange format
+// Copyright 2008 Google Inc.  All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+// This file contains GatheringOutputStreamAdaptor and
+// GatheringFileOutputStream, ZeroCopyOutputStreams that pass large aliased
+// buffers and absl::Cords to the underlying output by reference rather than
+// copying them.  Small writes are collected in owned blocks as usual; large
+// ones become separate chunks of a gather list, which is written in one go,
+// e.g. with writev().
+//
+// Aliasing only happens for data that reaches the stream through
+// WriteAliasedRaw() or WriteCord().  To serialize a message so that its large
+// string and bytes fields are referenced, enable aliasing on the
+// CodedOutputStream:
+//
+//   GatheringFileOutputStream output(fd);
+//   {
+//     CodedOutputStream coded_output(&output);
+//     coded_output.EnableAliasing(true);
+//     message.SerializeWithCachedSizes(&coded_output);
+//   }
+//   output.Flush();  // `message` must not change until this returns.
+//
+// absl::Cord fields are always passed by reference, whether aliasing is
+// enabled or not, since the stream keeps its own reference to the Cord.
+
+#ifndef GOOGLE_PROTOBUF_IO_GATHERING_OUTPUT_STREAM_H__
+#define GOOGLE_PROTOBUF_IO_GATHERING_OUTPUT_STREAM_H__
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <vector>
+
+#include "absl/strings/cord.h"
+#include "absl/strings/string_view.h"
+#include "absl/types/span.h"
+#include "google/protobuf/io/zero_copy_stream.h"
+
+// Must be included last.
+#include "google/protobuf/port_def.inc"
+
+namespace google {
+namespace protobuf {
+namespace io {
+
+// A generic traditional output stream interface that accepts a list of
+// buffers at once, like writev().  Implement this to use
+// GatheringOutputStreamAdaptor with something other than a file descriptor.
+class PROTOBUF_EXPORT GatheringOutputStream {
+ public:
+  virtual ~GatheringOutputStream() = default;
+
+  // Writes all of `chunks`, in order.  Returns true if successful, false on
+  // a write error.  The chunks are only valid during the call.
+  virtual bool Write(absl::Span<const absl::string_view> chunks) = 0;
+};
+
+// A ZeroCopyOutputStream which writes to a GatheringOutputStream.  Writes
+// through Next() and small aliased writes are copied into blocks owned by the
+// adaptor.  Aliased writes and Cords of at least Options::alias_threshold
+// bytes are not copied; instead they are added to the gather list between the
+// surrounding blocks.
+//
+// Data passed to WriteAliasedRaw() is referenced until the next Flush(),
+// which happens automatically once Options::flush_threshold bytes are
+// pending, so it must stay valid and unchanged until Flush() returns or the
+// stream is destroyed.  Cords are copied by reference and may be modified
+// right away.
+class PROTOBUF_EXPORT GatheringOutputStreamAdaptor : public ZeroCopyOutputStream {
+ public:
+  struct Options {
+    // Size of the owned blocks returned by Next().
+    int block_size = 16 << 10;
+    // Aliased writes and Cords of at least this many bytes are referenced
+    // instead of copied.  Next() never returns more than this many bytes at
+    // once, so that EpsCopyOutputStream passes every such write on to us.
+    int alias_threshold = 4 << 10;
+    // Flush() is called automatically once this many bytes are pending.
+    int64_t flush_threshold = 1 << 20;
+  };
+
+  explicit GatheringOutputStreamAdaptor(GatheringOutputStream* gathering_stream);
+  GatheringOutputStreamAdaptor(GatheringOutputStream* gathering_stream,
+                               const Options& options);
+  GatheringOutputStreamAdaptor(const GatheringOutputStreamAdaptor&) = delete;
+  GatheringOutputStreamAdaptor& operator=(const GatheringOutputStreamAdaptor&) =
+      delete;
+  // Calls Flush().
+  ~GatheringOutputStreamAdaptor() override;
+
+  // Writes all pending data to the underlying stream and releases the
+  // references to aliased data and Cords.  Returns false if a write error
+  // occurred on the underlying stream.
+  bool Flush();
+
+  // implements ZeroCopyOutputStream ---------------------------------
+  bool Next(void** data, int* size) override;
+  void BackUp(int count) override;
+  int64_t ByteCount() const override { return byte_count_; }
+  bool WriteAliasedRaw(const void* data, int size) override;
+  bool AllowsAliasing() const override { return true; }
+  bool WriteCord(const absl::Cord& cord) override;
+
+ private:
+  // Copies `data` into the owned blocks.
+  bool CopyRaw(const void* data, int size);
+  // Adds the bytes written to the current block since the last call to the
+  // gather list.
+  void EndChunk();
+  // Adds an external chunk to the gather list.
+  void AddChunk(absl::string_view chunk);
+  bool MaybeFlush();
+
+  GatheringOutputStream* gathering_stream_;
+  const Options options_;
+
+  // True if we have seen a permanent error from the underlying stream.
+  bool failed_ = false;
+  int64_t byte_count_ = 0;
+
+  // Owned blocks are reused after each Flush().  Bytes [chunk_begin_,
+  // block_pos_) of blocks_[current_block_] have been written but are not yet
+  // in chunks_.
+  std::vector<std::unique_ptr<char[]>> blocks_;
+  int current_block_ = -1;
+  char* chunk_begin_ = nullptr;
+  char* block_pos_ = nullptr;
+  char* block_end_ = nullptr;
+  int last_returned_size_ = 0;
+
+  // The gather list, and the Cords it points into.  A deque keeps the Cords'
+  // addresses stable, which matters for small Cords stored inline.
+  std::vector<absl::string_view> chunks_;
+  std::deque<absl::Cord> cords_;
+  int64_t pending_bytes_ = 0;
+};
+
+// ===================================================================
+
+// A ZeroCopyOutputStream which writes to a file descriptor with writev(), so
+// that large aliased buffers and Cords go straight from their owners to the
+// kernel.  On Windows, where writev() is not available, the chunks are
+// written one at a time.
+class PROTOBUF_EXPORT GatheringFileOutputStream final
+    : public GatheringOutputStreamAdaptor {
+ public:
+  explicit GatheringFileOutputStream(int file_descriptor);
+  GatheringFileOutputStream(int file_descriptor, const Options& options);
+  GatheringFileOutputStream(const GatheringFileOutputStream&) = delete;
+  GatheringFileOutputStream& operator=(const GatheringFileOutputStream&) =
+      delete;
+  ~GatheringFileOutputStream() override;
+
+  // Flushes any buffers and closes the underlying file.  Returns false if
+  // an error occurs during the process; use GetErrno() to examine the error.
+  // Even if an error occurs, the file descriptor is closed when this returns.
+  bool Close();
+
+  // Same as FileOutputStream.
+  void SetCloseOnDelete(bool value) { file_.SetCloseOnDelete(value); }
+  int GetErrno() const { return file_.GetErrno(); }
+
+ private:
+  class PROTOBUF_EXPORT GatheringFileStream final
+      : public GatheringOutputStream {
+   public:
+    explicit GatheringFileStream(int file_descriptor);
+    GatheringFileStream(const GatheringFileStream&) = delete;
+    GatheringFileStream& operator=(const GatheringFileStream&) = delete;
+    ~GatheringFileStream() override;
+
+    bool Close();
+    void SetCloseOnDelete(bool value) { close_on_delete_ = value; }
+    int GetErrno() const { return errno_; }
+
+    // implements GatheringOutputStream ------------------------------
+    bool Write(absl::Span<const absl::string_view> chunks) override;
+
+   private:
+    // Writes `size` bytes at `data` with write().
+    bool WriteAll(const char* data, size_t size);
+
+    const int file_;
+    bool close_on_delete_ = false;
+    bool is_closed_ = false;
+    // The errno of the I/O error, if one has occurred.  Otherwise, zero.
+    int errno_ = 0;
+  };
+
+  GatheringFileStream file_;
+};
+
+}  // namespace io
+}  // namespace protobuf
+}  // namespace google
+
+#include "google/protobuf/port_undef.inc"
+
+#endif  // GOOGLE_PROTOBUF_IO_GATHERING_OUTPUT_STREAM_H__
@@ -7,16 +7,24 @@
 
 // Author: brianolson@google.com (Brian Olson)
 //
-// This file contains the implementation of classes GzipInputStream and
-// GzipOutputStream.
+// This file contains the implementation of classes GzipInputStream,
+// GzipOutputStream and ParallelGzipOutputStream.
 
 
 #if HAVE_ZLIB
 #include "google/protobuf/io/gzip_stream.h"
 
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>  // NOLINT(build/c++11)
+#include <utility>
+
 #include "google/protobuf/stubs/common.h"
 #include "absl/log/absl_check.h"
 #include "absl/log/absl_log.h"
+#include "absl/synchronization/mutex.h"
 #include "google/protobuf/port.h"
 
 namespace google {
@@ -305,6 +313,350 @@ bool GzipOutputStream::Close() {
   return ok;
 }
 
+
+// ===================================================================
+
+namespace {
+
+constexpr int kDefaultParallelBlockSize = 128 << 10;
+// Deflate's window size; this much history is used as a preset dictionary.
+constexpr size_t kDictionarySize = 32 << 10;
+
+}  // namespace
+
+ParallelGzipOutputStream::Options::Options()
+    : format(GzipOutputStream::GZIP),
+      block_size(kDefaultParallelBlockSize),
+      compression_level(Z_DEFAULT_COMPRESSION),
+      compression_strategy(Z_DEFAULT_STRATEGY),
+      num_threads(0),
+      max_pending_blocks(0) {}
+
+ParallelGzipOutputStream::ParallelGzipOutputStream(
+    ZeroCopyOutputStream* sub_stream)
+    : ParallelGzipOutputStream(sub_stream, Options()) {}
+
+ParallelGzipOutputStream::ParallelGzipOutputStream(
+    ZeroCopyOutputStream* sub_stream, const Options& options)
+    : sub_stream_(sub_stream),
+      format_(options.format),
+      block_size_(options.block_size > 0 ? options.block_size
+                                         : kDefaultParallelBlockSize),
+      compression_level_(options.compression_level),
+      compression_strategy_(options.compression_strategy),
+      check_(format_ == GzipOutputStream::ZLIB ? adler32(0L, Z_NULL, 0)
+                                               : crc32(0L, Z_NULL, 0)) {
+  int num_threads = options.num_threads;
+  if (num_threads <= 0) {
+    num_threads = std::max(1u, std::thread::hardware_concurrency());
+  }
+  max_pending_ = options.max_pending_blocks > 0 ? options.max_pending_blocks
+                                                : 2 * num_threads;
+  workers_.reserve(num_threads);
+  for (int i = 0; i < num_threads; ++i) {
+    workers_.emplace_back(&ParallelGzipOutputStream::CompressLoop, this);
+  }
+}
+
+ParallelGzipOutputStream::~ParallelGzipOutputStream() {
+  Close();
+  StopWorkers();
+}
+
+void ParallelGzipOutputStream::StopWorkers() {
+  {
+    absl::MutexLock lock(&mu_);
+    stop_ = true;
+  }
+  for (std::thread& worker : workers_) {
+    worker.join();
+  }
+  workers_.clear();
+}
+
+void ParallelGzipOutputStream::CompressLoop() {
+  z_stream zcontext;
+  zcontext.zalloc = Z_NULL;
+  zcontext.zfree = Z_NULL;
+  zcontext.opaque = Z_NULL;
+  // Raw deflate; the caller's thread writes the gzip or zlib wrapper.
+  int error = deflateInit2(&zcontext, compression_level_, Z_DEFLATED,
+                           /* windowBits */ -15,
+                           /* memLevel (default) */ 8, compression_strategy_);
+  while (true) {
+    Block* block;
+    {
+      absl::MutexLock lock(&mu_);
+      mu_.Await(absl::Condition(this, &ParallelGzipOutputStream::HasWork));
+      // Queued blocks are always finished, so that Drain() cannot hang.
+      if (unclaimed_ == pending_.size()) break;
+      block = pending_[unclaimed_++].get();
+    }
+
+    if (error == Z_OK) {
+      CompressBlock(&zcontext, block);
+    } else {
+      block->error = error;
+      block->message = zcontext.msg;
+    }
+
+    absl::MutexLock lock(&mu_);
+    block->done = true;
+  }
+  if (error == Z_OK) deflateEnd(&zcontext);
+}
+
+void ParallelGzipOutputStream::CompressBlock(z_stream* zcontext,
+                                             Block* block) const {
+  block->output_size = 0;
+  block->error = deflateReset(zcontext);
+  if (block->error == Z_OK && !block->dictionary.empty()) {
+    block->error = deflateSetDictionary(
+        zcontext, reinterpret_cast<const Bytef*>(block->dictionary.data()),
+        block->dictionary.size());
+  }
+  if (block->error != Z_OK) {
+    block->message = zcontext->msg;
+    return;
+  }
+
+  zcontext->next_in = reinterpret_cast<Bytef*>(block->input.get());
+  zcontext->avail_in = block->input_size;
+  // Room for the whole block plus the sync flush marker, so that the loop
+  // below normally runs once.
+  size_t needed = deflateBound(zcontext, block->input_size) + 8;
+  const int flush = block->last ? Z_FINISH : Z_SYNC_FLUSH;
+  while (true) {
+    if (block->output_capacity - block->output_size < needed) {
+      size_t capacity = std::max(block->output_size + needed,
+                                 2 * block->output_capacity);
+      auto output = std::make_unique<char[]>(capacity);
+      memcpy(output.get(), block->output.get(), block->output_size);
+      block->output = std::move(output);
+      block->output_capacity = capacity;
+    }
+    zcontext->next_out =
+        reinterpret_cast<Bytef*>(block->output.get() + block->output_size);
+    zcontext->avail_out = block->output_capacity - block->output_size;
+    int error = deflate(zcontext, flush);
+    block->output_size = block->output_capacity - zcontext->avail_out;
+    if (error == Z_STREAM_ERROR) {
+      block->error = error;
+      block->message = zcontext->msg;
+      return;
+    }
+    // All input is consumed and flushed once deflate() stops filling the
+    // output buffer.
+    if (flush == Z_FINISH ? error == Z_STREAM_END
+                          : zcontext->avail_out != 0) {
+      break;
+    }
+    needed = block->output_capacity;
+  }
+
+  const Bytef* input = reinterpret_cast<const Bytef*>(block->input.get());
+  if (format_ == GzipOutputStream::ZLIB) {
+    block->check = adler32(adler32(0L, Z_NULL, 0), input, block->input_size);
+  } else {
+    block->check = crc32(crc32(0L, Z_NULL, 0), input, block->input_size);
+  }
+}
+
+// implements ZeroCopyOutputStream ---------------------------------
+bool ParallelGzipOutputStream::Next(void** data, int* size) {
+  if (closed_ || zerror_ != Z_OK) {
+    return false;
+  }
+  if (current_ == nullptr || current_->input_size == block_size_) {
+    Submit(/* last */ false);
+    if (!Drain(max_pending_)) {
+      return false;
+    }
+    if (current_ == nullptr) {
+      if (free_blocks_.empty()) {
+        current_ = std::make_unique<Block>();
+        current_->input = std::make_unique<char[]>(block_size_);
+      } else {
+        current_ = std::move(free_blocks_.back());
+        free_blocks_.pop_back();
+      }
+      current_->input_size = 0;
+      current_->last = false;
+      current_->done = false;
+    }
+  }
+  *data = current_->input.get() + current_->input_size;
+  *size = block_size_ - current_->input_size;
+  current_->input_size = block_size_;
+  return true;
+}
+
+void ParallelGzipOutputStream::BackUp(int count) {
+  ABSL_CHECK(current_ != nullptr);
+  ABSL_CHECK_GE(current_->input_size, count);
+  current_->input_size -= count;
+}
+
+int64_t ParallelGzipOutputStream::ByteCount() const {
+  return submitted_bytes_ + (current_ != nullptr ? current_->input_size : 0);
+}
+
+void ParallelGzipOutputStream::Submit(bool last) {
+  if (current_ == nullptr) {
+    if (!last) return;
+    // The final block is needed even if it is empty.
+    current_ = std::make_unique<Block>();
+  } else if (!last && current_->input_size == 0) {
+    return;
+  }
+
+  Block* block = current_.get();
+  block->last = last;
+  block->error = Z_OK;
+  block->message = nullptr;
+  block->dictionary = history_;
+  const char* input = block->input.get();
+  const size_t input_size = block->input_size;
+  if (input_size >= kDictionarySize) {
+    history_.assign(input + input_size - kDictionarySize, kDictionarySize);
+  } else {
+    history_.append(input, input_size);
+    if (history_.size() > kDictionarySize) {
+      history_.erase(0, history_.size() - kDictionarySize);
+    }
+  }
+  submitted_bytes_ += input_size;
+
+  absl::MutexLock lock(&mu_);
+  pending_.push_back(std::move(current_));
+}
+
+bool ParallelGzipOutputStream::Drain(size_t max_pending) {
+  while (true) {
+    std::unique_ptr<Block> block;
+    {
+      absl::MutexLock lock(&mu_);
+      if (pending_.empty()) break;
+      if (!pending_.front()->done) {
+        if (pending_.size() <= max_pending) break;
+        mu_.Await(absl::Condition(this, &ParallelGzipOutputStream::FrontDone));
+      }
+      block = std::move(pending_.front());
+      pending_.pop_front();
+      --unclaimed_;
+    }
+
+    // After an error, blocks are still collected but no longer written.
+    if (zerror_ == Z_OK) {
+      if (block->error != Z_OK) {
+        zerror_ = block->error;
+        zmessage_ = block->message;
+      } else if (WriteHeader() &&
+                 WriteToSubStream(block->output.get(), block->output_size)) {
+        if (format_ == GzipOutputStream::ZLIB) {
+          check_ = adler32_combine(check_, block->check, block->input_size);
+        } else {
+          check_ = crc32_combine(check_, block->check, block->input_size);
+        }
+      }
+    }
+    free_blocks_.push_back(std::move(block));
+  }
+  return zerror_ == Z_OK;
+}
+
+bool ParallelGzipOutputStream::WriteToSubStream(const void* data,
+                                                size_t size) {
+  const char* source = static_cast<const char*>(data);
+  while (size > 0) {
+    void* buffer;
+    int buffer_size;
+    if (!sub_stream_->Next(&buffer, &buffer_size)) {
+      zerror_ = Z_BUF_ERROR;
+      zmessage_ = "failed to write to the underlying stream";
+      return false;
+    }
+    const size_t n = std::min(size, static_cast<size_t>(buffer_size));
+    memcpy(buffer, source, n);
+    source += n;
+    size -= n;
+    if (n < static_cast<size_t>(buffer_size)) {
+      sub_stream_->BackUp(buffer_size - n);
+    }
+  }
+  return true;
+}
+
+bool ParallelGzipOutputStream::WriteHeader() {
+  if (header_written_) return true;
+  header_written_ = true;
+  if (format_ == GzipOutputStream::ZLIB) {
+    // CMF: deflate with a 32kB window.  FLG: compression level hint, no
+    // preset dictionary, and check bits making the pair a multiple of 31.
+    const uint8_t cmf = 0x78;
+    uint8_t level;
+    if (compression_level_ == Z_DEFAULT_COMPRESSION ||
+        compression_level_ == 6) {
+      level = 2;
+    } else if (compression_level_ >= 7) {
+      level = 3;
+    } else if (compression_level_ >= 2) {
+      level = 1;
+    } else {
+      level = 0;
+    }
+    uint8_t flg = level << 6;
+    flg += 31 - (cmf * 256 + flg) % 31;
+    const uint8_t header[] = {cmf, flg};
+    return WriteToSubStream(header, sizeof(header));
+  }
+  // Magic, CM = deflate, no flags, no mtime, no extra flags, unknown OS.
+  static const uint8_t kGzipHeader[] = {0x1f, 0x8b, 8, 0, 0, 0, 0, 0, 0, 0xff};
+  return WriteToSubStream(kGzipHeader, sizeof(kGzipHeader));
+}
+
+bool ParallelGzipOutputStream::WriteTrailer() {
+  uint8_t trailer[8];
+  if (format_ == GzipOutputStream::ZLIB) {
+    // Adler-32, big-endian.
+    for (int i = 0; i < 4; ++i) {
+      trailer[i] = static_cast<uint8_t>(check_ >> (24 - 8 * i));
+    }
+    return WriteToSubStream(trailer, 4);
+  }
+  // CRC-32 and the input size modulo 2^32, little-endian.
+  const uint32_t input_size = static_cast<uint32_t>(submitted_bytes_);
+  for (int i = 0; i < 4; ++i) {
+    trailer[i] = static_cast<uint8_t>(check_ >> (8 * i));
+    trailer[4 + i] = static_cast<uint8_t>(input_size >> (8 * i));
+  }
+  return WriteToSubStream(trailer, sizeof(trailer));
+}
+
+bool ParallelGzipOutputStream::Flush() {
+  if (closed_ || zerror_ != Z_OK) {
+    return false;
+  }
+  Submit(/* last */ false);
+  return Drain(0);
+}
+
+bool ParallelGzipOutputStream::Close() {
+  if (closed_) {
+    return zerror_ == Z_OK;
+  }
+  closed_ = true;
+  if (zerror_ == Z_OK) {
+    Submit(/* last */ true);
+  }
+  if (Drain(0)) {
+    WriteTrailer();
+  }
+  StopWorkers();
+  free_blocks_.clear();
+  return zerror_ == Z_OK;
+}
+
 }  // namespace io
 }  // namespace protobuf
 }  // namespace google
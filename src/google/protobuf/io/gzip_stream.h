@@ -16,11 +16,24 @@
 //
 // GzipOutputStream is an ZeroCopyOutputStream that compresses data to
 // an underlying ZeroCopyOutputStream.
+//
+// ParallelGzipOutputStream produces the same formats as GzipOutputStream, but
+// compresses independent blocks of its input on a pool of worker threads.
 
 #ifndef GOOGLE_PROTOBUF_IO_GZIP_STREAM_H__
 #define GOOGLE_PROTOBUF_IO_GZIP_STREAM_H__
 
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <string>
+#include <thread>  // NOLINT(build/c++11)
+#include <vector>
+
 #include "google/protobuf/stubs/common.h"
+#include "absl/base/thread_annotations.h"
+#include "absl/synchronization/mutex.h"
 #include "google/protobuf/io/zero_copy_stream.h"
 #include "google/protobuf/port.h"
 #include "zlib.h"
@@ -170,6 +183,152 @@ class PROTOBUF_EXPORT GzipOutputStream final : public ZeroCopyOutputStream {
   int Deflate(int flush);
 };
 
+// A ZeroCopyOutputStream that writes gzip or zlib data like GzipOutputStream,
+// but spreads the compression work over several threads.
+//
+// The input is cut into blocks of Options::block_size bytes.  Each block is
+// deflated on its own by a worker thread, using the last 32kB of the preceding
+// input as a preset dictionary so that the compression ratio stays close to
+// that of a single deflate stream.  The compressed blocks are byte-aligned
+// with a sync flush and written to the underlying stream in order, as one
+// gzip (or zlib) member, so the result can be read with GzipInputStream or any
+// other gzip decoder.
+//
+// At most Options::max_pending_blocks blocks are queued or being compressed
+// at a time; Next() blocks while the queue is full.  The underlying stream is
+// only ever used from the thread that calls Next(), Flush() and Close().
+class PROTOBUF_EXPORT ParallelGzipOutputStream final
+    : public ZeroCopyOutputStream {
+ public:
+  using Format = GzipOutputStream::Format;
+
+  struct PROTOBUF_EXPORT Options {
+    // Defaults to GZIP.
+    Format format;
+
+    // How much input to compress as one unit.  Smaller blocks give more
+    // parallelism for small messages but compress slightly worse.  Defaults
+    // to 128kB.
+    int block_size;
+
+    // As for GzipOutputStream::Options.
+    int compression_level;
+    int compression_strategy;
+
+    // Number of worker threads.  Defaults to 0, which means one per hardware
+    // thread.
+    int num_threads;
+
+    // Maximum number of blocks waiting to be compressed or written.  Defaults
+    // to 0, which means twice the number of worker threads.
+    int max_pending_blocks;
+
+    Options();  // Initializes with default values.
+  };
+
+  // Create a ParallelGzipOutputStream with default options.
+  explicit ParallelGzipOutputStream(ZeroCopyOutputStream* sub_stream);
+
+  // Create a ParallelGzipOutputStream with the given options.
+  ParallelGzipOutputStream(ZeroCopyOutputStream* sub_stream,
+                           const Options& options);
+  ParallelGzipOutputStream(const ParallelGzipOutputStream&) = delete;
+  ParallelGzipOutputStream& operator=(const ParallelGzipOutputStream&) =
+      delete;
+
+  // Closes the stream and stops the worker threads.
+  ~ParallelGzipOutputStream() override;
+
+  // Return last error message or NULL if no error.
+  inline const char* ZlibErrorMessage() const { return zmessage_; }
+  inline int ZlibErrorCode() const { return zerror_; }
+
+  // Compresses everything written so far and writes it to the underlying
+  // stream, waiting for the worker threads as necessary.  As with
+  // GzipOutputStream::Flush(), it is the caller's responsibility to flush the
+  // underlying stream.  Returns true if no error.
+  bool Flush();
+
+  // Writes out all data and closes the gzip stream.
+  // It is the caller's responsibility to close the underlying stream if
+  // necessary.
+  // Returns true if no error.
+  bool Close();
+
+  // implements ZeroCopyOutputStream ---------------------------------
+  bool Next(void** data, int* size) override;
+  void BackUp(int count) override;
+  int64_t ByteCount() const override;
+
+ private:
+  struct Block {
+    std::unique_ptr<char[]> input;
+    int input_size = 0;
+    // Tail of the input preceding this block.
+    std::string dictionary;
+    bool last = false;
+
+    // Filled in by the worker thread.
+    std::unique_ptr<char[]> output;
+    size_t output_capacity = 0;
+    size_t output_size = 0;
+    uLong check = 0;  // crc32 or adler32 of the input.
+    int error = Z_OK;
+    const char* message = nullptr;
+    bool done = false;
+  };
+
+  // Body of the worker threads.
+  void CompressLoop();
+  // Deflates `block` with `zcontext`, a raw deflate stream.
+  void CompressBlock(z_stream* zcontext, Block* block) const;
+
+  // Queues the block the caller is filling, if any, for compression.
+  void Submit(bool last);
+  // Writes compressed blocks to the underlying stream in order, waiting until
+  // no more than `max_pending` blocks remain queued.
+  bool Drain(size_t max_pending);
+  bool WriteToSubStream(const void* data, size_t size);
+  bool WriteHeader();
+  bool WriteTrailer();
+  void StopWorkers();
+
+  bool HasWork() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    return stop_ || unclaimed_ < pending_.size();
+  }
+  bool FrontDone() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    return pending_.front()->done;
+  }
+
+  ZeroCopyOutputStream* const sub_stream_;
+  const Format format_;
+  const int block_size_;
+  const int compression_level_;
+  const int compression_strategy_;
+  size_t max_pending_;
+
+  mutable absl::Mutex mu_;
+  // Blocks in output order.  Workers compress them in this order too, and
+  // those before unclaimed_ have been taken by a worker.
+  std::deque<std::unique_ptr<Block>> pending_ ABSL_GUARDED_BY(mu_);
+  size_t unclaimed_ ABSL_GUARDED_BY(mu_) = 0;
+  bool stop_ ABSL_GUARDED_BY(mu_) = false;
+
+  std::vector<std::thread> workers_;
+
+  // State used only by the caller's thread.
+  std::unique_ptr<Block> current_;
+  std::vector<std::unique_ptr<Block>> free_blocks_;
+  // The last (up to) 32kB of input submitted so far.
+  std::string history_;
+  int64_t submitted_bytes_ = 0;
+  uLong check_;
+  bool header_written_ = false;
+  bool closed_ = false;
+  int zerror_ = Z_OK;
+  const char* zmessage_ = nullptr;
+};
+
 }  // namespace io
 }  // namespace protobuf
 }  // namespace google
@@ -0,0 +1,254 @@
+// Protocol Buffers - Google's data interchange format
+// Copyright 2008 Google Inc.  All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+// This file contains the implementation of classes Lz4InputStream and
+// Lz4OutputStream.
+
+#if HAVE_LZ4
+#include "google/protobuf/io/lz4_stream.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include "absl/log/absl_check.h"
+#include "absl/strings/string_view.h"
+#include "google/protobuf/port.h"
+
+// Dictionary support is in the static-linking-only part of the API.
+#define LZ4F_STATIC_LINKING_ONLY
+#include "lz4frame.h"
+
+namespace google {
+namespace protobuf {
+namespace io {
+
+namespace {
+
+constexpr int kDefaultBufferSize = 65536;
+
+}  // namespace
+
+Lz4InputStream::Lz4InputStream(ZeroCopyInputStream* sub_stream,
+                               absl::string_view dictionary, int buffer_size)
+    : sub_stream_(sub_stream), dictionary_(dictionary) {
+  const size_t result = LZ4F_createDecompressionContext(&dctx_, LZ4F_VERSION);
+  ABSL_CHECK(!LZ4F_isError(result)) << LZ4F_getErrorName(result);
+  output_buffer_length_ = buffer_size > 0 ? buffer_size : kDefaultBufferSize;
+  output_buffer_ = static_cast<char*>(operator new(output_buffer_length_));
+  output_position_ = output_end_ = output_buffer_;
+}
+
+Lz4InputStream::~Lz4InputStream() {
+  internal::SizedDelete(output_buffer_, output_buffer_length_);
+  LZ4F_freeDecompressionContext(dctx_);
+}
+
+bool Lz4InputStream::Decompress() {
+  size_t output_size = 0;
+  while (output_size == 0) {
+    if (input_size_ == 0 && !output_pending_) {
+      const void* data;
+      int size;
+      if (!sub_stream_->Next(&data, &size)) {
+        if (!frame_done_) error_message_ = "Truncated LZ4 frame";
+        return false;
+      }
+      input_ = static_cast<const char*>(data);
+      input_size_ = static_cast<size_t>(size);
+      if (size == 0) continue;
+    }
+    size_t consumed = input_size_;
+    output_size = output_buffer_length_;
+    const size_t hint = LZ4F_decompress_usingDict(
+        dctx_, output_buffer_, &output_size, input_, &consumed,
+        dictionary_.data(), dictionary_.size(), nullptr);
+    if (LZ4F_isError(hint)) {
+      error_message_ = LZ4F_getErrorName(hint);
+      return false;
+    }
+    input_ += consumed;
+    input_size_ -= consumed;
+    frame_done_ = hint == 0;
+    // A finished frame has been fully flushed, even if it filled the buffer.
+    output_pending_ = !frame_done_ && output_size == output_buffer_length_;
+  }
+  output_position_ = output_buffer_;
+  output_end_ = output_buffer_ + output_size;
+  return true;
+}
+
+// implements ZeroCopyInputStream ----------------------------------
+bool Lz4InputStream::Next(const void** data, int* size) {
+  if (error_message_ != nullptr) return false;
+  if (output_position_ == output_end_ && !Decompress()) return false;
+  *data = output_position_;
+  *size = static_cast<int>(output_end_ - output_position_);
+  byte_count_ += *size;
+  output_position_ = output_end_;
+  return true;
+}
+
+void Lz4InputStream::BackUp(int count) {
+  ABSL_CHECK_GE(count, 0);
+  ABSL_CHECK_LE(count, output_position_ - output_buffer_);
+  output_position_ -= count;
+  byte_count_ -= count;
+}
+
+bool Lz4InputStream::Skip(int count) {
+  const void* data;
+  int size = 0;
+  bool ok = Next(&data, &size);
+  while (ok && (size < count)) {
+    count -= size;
+    ok = Next(&data, &size);
+  }
+  if (size > count) {
+    BackUp(size - count);
+  }
+  return ok;
+}
+
+// =========================================================================
+
+Lz4OutputStream::Lz4OutputStream(ZeroCopyOutputStream* sub_stream)
+    : Lz4OutputStream(sub_stream, Options()) {}
+
+Lz4OutputStream::Lz4OutputStream(ZeroCopyOutputStream* sub_stream,
+                                 const Options& options)
+    : sub_stream_(sub_stream) {
+  const size_t result = LZ4F_createCompressionContext(&cctx_, LZ4F_VERSION);
+  ABSL_CHECK(!LZ4F_isError(result)) << LZ4F_getErrorName(result);
+  if (!options.dictionary.empty()) {
+    cdict_ =
+        LZ4F_createCDict(options.dictionary.data(), options.dictionary.size());
+    ABSL_CHECK(cdict_ != nullptr);
+  }
+
+  std::memset(&preferences_, 0, sizeof(preferences_));
+  preferences_.compressionLevel = options.compression_level;
+  preferences_.frameInfo.contentChecksumFlag =
+      options.checksum ? LZ4F_contentChecksumEnabled : LZ4F_noContentChecksum;
+
+  input_buffer_length_ =
+      options.buffer_size > 0 ? options.buffer_size : kDefaultBufferSize;
+  input_buffer_ = static_cast<char*>(operator new(input_buffer_length_));
+  compressed_buffer_length_ =
+      LZ4F_HEADER_SIZE_MAX +
+      LZ4F_compressBound(input_buffer_length_, &preferences_);
+  compressed_buffer_ =
+      static_cast<char*>(operator new(compressed_buffer_length_));
+}
+
+Lz4OutputStream::~Lz4OutputStream() {
+  Close();
+  internal::SizedDelete(compressed_buffer_, compressed_buffer_length_);
+  internal::SizedDelete(input_buffer_, input_buffer_length_);
+  LZ4F_freeCDict(cdict_);
+  LZ4F_freeCompressionContext(cctx_);
+}
+
+bool Lz4OutputStream::CheckError(size_t code) {
+  if (!LZ4F_isError(code)) return false;
+  error_message_ = LZ4F_getErrorName(code);
+  return true;
+}
+
+// private
+bool Lz4OutputStream::Compress(Mode mode) {
+  size_t size = 0;
+  if (!frame_started_) {
+    const size_t header =
+        cdict_ != nullptr
+            ? LZ4F_compressBegin_usingCDict(cctx_, compressed_buffer_,
+                                            compressed_buffer_length_, cdict_,
+                                            &preferences_)
+            : LZ4F_compressBegin(cctx_, compressed_buffer_,
+                                 compressed_buffer_length_, &preferences_);
+    if (CheckError(header)) return false;
+    size += header;
+    frame_started_ = true;
+  }
+  if (input_used_ != 0) {
+    const size_t written = LZ4F_compressUpdate(
+        cctx_, compressed_buffer_ + size, compressed_buffer_length_ - size,
+        input_buffer_, input_used_, nullptr);
+    if (CheckError(written)) return false;
+    size += written;
+    input_used_ = 0;
+  }
+  if (mode != Mode::kContinue) {
+    const size_t written =
+        mode == Mode::kFlush
+            ? LZ4F_flush(cctx_, compressed_buffer_ + size,
+                         compressed_buffer_length_ - size, nullptr)
+            : LZ4F_compressEnd(cctx_, compressed_buffer_ + size,
+                               compressed_buffer_length_ - size, nullptr);
+    if (CheckError(written)) return false;
+    size += written;
+    if (mode == Mode::kEnd) frame_started_ = false;
+  }
+  return WriteCompressed(size);
+}
+
+bool Lz4OutputStream::WriteCompressed(size_t size) {
+  const char* data = compressed_buffer_;
+  while (size > 0) {
+    void* out;
+    int out_size;
+    if (!sub_stream_->Next(&out, &out_size)) {
+      error_message_ = "Failed to write to the underlying stream";
+      return false;
+    }
+    const size_t n = std::min(size, static_cast<size_t>(out_size));
+    std::memcpy(out, data, n);
+    data += n;
+    size -= n;
+    if (n < static_cast<size_t>(out_size)) {
+      sub_stream_->BackUp(static_cast<int>(out_size - n));
+    }
+  }
+  return true;
+}
+
+// implements ZeroCopyOutputStream ---------------------------------
+bool Lz4OutputStream::Next(void** data, int* size) {
+  if (error_message_ != nullptr || closed_) return false;
+  if (input_used_ != 0 && !Compress(Mode::kContinue)) return false;
+  input_used_ = input_buffer_length_;
+  byte_count_ += input_buffer_length_;
+  *data = input_buffer_;
+  *size = static_cast<int>(input_buffer_length_);
+  return true;
+}
+
+void Lz4OutputStream::BackUp(int count) {
+  ABSL_CHECK_GE(count, 0);
+  ABSL_CHECK_LE(static_cast<size_t>(count), input_used_);
+  input_used_ -= count;
+  byte_count_ -= count;
+}
+
+bool Lz4OutputStream::Flush() {
+  if (error_message_ != nullptr || closed_) return false;
+  return Compress(Mode::kFlush);
+}
+
+bool Lz4OutputStream::Close() {
+  if (closed_) return error_message_ == nullptr;
+  closed_ = true;
+  if (error_message_ != nullptr) return false;
+  return Compress(Mode::kEnd);
+}
+
+}  // namespace io
+}  // namespace protobuf
+}  // namespace google
+
+#endif  // HAVE_LZ4
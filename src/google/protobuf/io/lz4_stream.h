@@ -0,0 +1,171 @@
+// Protocol Buffers - Google's data interchange format
+// Copyright 2008 Google Inc.  All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+// This file contains the definition for classes Lz4InputStream and
+// Lz4OutputStream, which are analogous to GzipInputStream and
+// GzipOutputStream but use the LZ4 frame format.  LZ4 compresses less than
+// zlib or Zstandard, but compresses and decompresses much faster than either.
+
+#ifndef GOOGLE_PROTOBUF_IO_LZ4_STREAM_H__
+#define GOOGLE_PROTOBUF_IO_LZ4_STREAM_H__
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "absl/strings/string_view.h"
+#include "google/protobuf/io/zero_copy_stream.h"
+#include "lz4frame.h"
+
+// Only declared by lz4frame.h under LZ4F_STATIC_LINKING_ONLY before LZ4 1.10.
+typedef struct LZ4F_CDict_s LZ4F_CDict;
+
+// Must be included last.
+#include "google/protobuf/port_def.inc"
+
+namespace google {
+namespace protobuf {
+namespace io {
+
+// A ZeroCopyInputStream that decompresses LZ4 frames read from another
+// stream.  Concatenated frames are decompressed as one stream.
+class PROTOBUF_EXPORT Lz4InputStream final : public ZeroCopyInputStream {
+ public:
+  // If the data was compressed with a dictionary, `dictionary` must hold the
+  // same dictionary; it is copied.  A buffer_size of -1, or any other value
+  // that is not positive, selects a default of 64kB.
+  explicit Lz4InputStream(ZeroCopyInputStream* sub_stream,
+                          absl::string_view dictionary = {},
+                          int buffer_size = -1);
+  Lz4InputStream(const Lz4InputStream&) = delete;
+  Lz4InputStream& operator=(const Lz4InputStream&) = delete;
+  ~Lz4InputStream() override;
+
+  // Return last error message or NULL if no error.
+  const char* Lz4ErrorMessage() const { return error_message_; }
+
+  // implements ZeroCopyInputStream ----------------------------------
+  bool Next(const void** data, int* size) override;
+  void BackUp(int count) override;
+  bool Skip(int count) override;
+  int64_t ByteCount() const override { return byte_count_; }
+
+ private:
+  // Decompresses into the output buffer.  Returns false at the end of the
+  // stream or on error.
+  bool Decompress();
+
+  ZeroCopyInputStream* sub_stream_;
+  LZ4F_dctx* dctx_ = nullptr;
+  std::string dictionary_;
+  const char* error_message_ = nullptr;
+
+  // Compressed data from sub_stream_ that has not been decompressed yet.
+  const char* input_ = nullptr;
+  size_t input_size_ = 0;
+  // True if the last decompression call filled the output buffer and may
+  // have more output pending.
+  bool output_pending_ = false;
+  // True if the input seen so far ends at a frame boundary.
+  bool frame_done_ = true;
+
+  char* output_buffer_;
+  size_t output_buffer_length_;
+  // [output_position_, output_end_) has been decompressed but not returned.
+  char* output_position_;
+  char* output_end_;
+  int64_t byte_count_ = 0;
+};
+
+// A ZeroCopyOutputStream that compresses data to another stream as an LZ4
+// frame.
+class PROTOBUF_EXPORT Lz4OutputStream final : public ZeroCopyOutputStream {
+ public:
+  struct PROTOBUF_EXPORT Options {
+    // What size buffer to use internally.  Defaults to 64kB.
+    int buffer_size = 64 * 1024;
+
+    // 0 (the default) selects the fast LZ4 compressor; values from
+    // LZ4HC_CLEVEL_MIN (3) to LZ4HC_CLEVEL_MAX (12) select LZ4 HC, which
+    // compresses better but more slowly.  Negative values compress faster.
+    int compression_level = 0;
+
+    // Whether to append a checksum of the uncompressed data to the frame.
+    bool checksum = false;
+
+    // Optional dictionary to compress with; the same one must be passed to
+    // Lz4InputStream.  It is copied.
+    absl::string_view dictionary;
+  };
+
+  // Create an Lz4OutputStream with default options.
+  explicit Lz4OutputStream(ZeroCopyOutputStream* sub_stream);
+
+  // Create an Lz4OutputStream with the given options.
+  Lz4OutputStream(ZeroCopyOutputStream* sub_stream, const Options& options);
+  Lz4OutputStream(const Lz4OutputStream&) = delete;
+  Lz4OutputStream& operator=(const Lz4OutputStream&) = delete;
+
+  ~Lz4OutputStream() override;
+
+  // Return last error message or NULL if no error.
+  const char* Lz4ErrorMessage() const { return error_message_; }
+
+  // Flushes data written so far to compressed data in the underlying stream,
+  // so that a reader can decompress everything written before the flush.
+  // It is the caller's responsibility to flush the underlying stream if
+  // necessary.  Returns true if no error.
+  bool Flush();
+
+  // Writes out all data and ends the frame.  It is the caller's
+  // responsibility to close the underlying stream if necessary.
+  // Returns true if no error.
+  bool Close();
+
+  // implements ZeroCopyOutputStream ---------------------------------
+  bool Next(void** data, int* size) override;
+  void BackUp(int count) override;
+  int64_t ByteCount() const override { return byte_count_; }
+
+ private:
+  enum class Mode { kContinue, kFlush, kEnd };
+
+  // Compresses the input buffer and writes the result to sub_stream_.
+  bool Compress(Mode mode);
+  // Copies `size` bytes of compressed_buffer_ to sub_stream_.
+  bool WriteCompressed(size_t size);
+  // Records an LZ4F error code; returns true if `code` is an error.
+  bool CheckError(size_t code);
+
+  ZeroCopyOutputStream* sub_stream_;
+  LZ4F_cctx* cctx_ = nullptr;
+  LZ4F_CDict* cdict_ = nullptr;
+  LZ4F_preferences_t preferences_;
+  const char* error_message_ = nullptr;
+  bool frame_started_ = false;
+  bool closed_ = false;
+
+  char* input_buffer_;
+  size_t input_buffer_length_;
+  // The first input_used_ bytes of input_buffer_ hold data to compress.
+  size_t input_used_ = 0;
+
+  // Large enough for the compressed form of a full input buffer, plus the
+  // frame header and footer.
+  char* compressed_buffer_;
+  size_t compressed_buffer_length_;
+
+  int64_t byte_count_ = 0;
+};
+
+}  // namespace io
+}  // namespace protobuf
+}  // namespace google
+
+#include "google/protobuf/port_undef.inc"
+
+#endif  // GOOGLE_PROTOBUF_IO_LZ4_STREAM_H__
@@ -10,6 +10,7 @@
 #include <float.h>  // FLT_DIG and DBL_DIG
 
 #include <cmath>
+#include <cstdint>
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
@@ -155,6 +156,37 @@ void DelocalizeRadix(char *buffer) {
   }
 }
 
+// Integral values below 10^precision are printed by "%.*g" as plain decimal
+// integers, which is also the shortest representation that round-trips.  They
+// are very common in practice (counters, ids, timestamps stored as doubles),
+// so we format them directly and skip both snprintf() and the strtod()
+// round-trip check below.  Returns false if `value` does not qualify; NaN
+// never does.
+bool IntegralToBuffer(double value, double limit, char *buffer) {
+  if (!(value > -limit && value < limit)) return false;
+  const int64_t integral = static_cast<int64_t>(value);
+  if (static_cast<double>(integral) != value) return false;
+
+  char digits[24];
+  char *end = digits + sizeof(digits);
+  char *p = end;
+  uint64_t magnitude = integral < 0 ? 0 - static_cast<uint64_t>(integral)
+                                    : static_cast<uint64_t>(integral);
+  do {
+    *--p = static_cast<char>('0' + magnitude % 10);
+    magnitude /= 10;
+  } while (magnitude != 0);
+  // std::signbit() also catches -0.0, which "%g" prints as "-0".
+  if (std::signbit(value)) *--p = '-';
+  memcpy(buffer, p, end - p);
+  buffer[end - p] = '\0';
+  return true;
+}
+
+// 10^FLT_DIG and 10^DBL_DIG, the bounds for IntegralToBuffer().
+constexpr double kFloatIntegralLimit = 1e6;
+constexpr double kDoubleIntegralLimit = 1e15;
+
 bool safe_strtof(const char *str, float *value) {
   char *endptr;
   errno = 0;  // errno only gets set on errors
@@ -169,6 +201,8 @@ char *FloatToBuffer(float value, char *buffer) {
   // this assert.
   static_assert(FLT_DIG < 10, "FLT_DIG_is_too_big");
 
+  if (IntegralToBuffer(value, kFloatIntegralLimit, buffer)) return buffer;
+
   if (value == std::numeric_limits<double>::infinity()) {
     absl::SNPrintF(buffer, kFloatToBufferSize, "inf");
     return buffer;
@@ -207,6 +241,8 @@ char *DoubleToBuffer(double value, char *buffer) {
   // this assert.
   static_assert(DBL_DIG < 20, "DBL_DIG_is_too_big");
 
+  if (IntegralToBuffer(value, kDoubleIntegralLimit, buffer)) return buffer;
+
   if (value == std::numeric_limits<double>::infinity()) {
     absl::SNPrintF(buffer, kDoubleToBufferSize, "inf");
     return buffer;
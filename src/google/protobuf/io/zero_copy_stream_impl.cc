@@ -15,10 +15,16 @@
 #include <sys/types.h>
 #include <unistd.h>
 #endif
+#ifndef _WIN32
+#include <sys/mman.h>
+#endif
 #include <errno.h>
 
 #include <algorithm>
+#include <cstddef>
+#include <cstdint>
 #include <iostream>
+#include <limits>
 
 #include "google/protobuf/stubs/common.h"
 #include "absl/log/absl_check.h"
@@ -147,6 +153,133 @@ int FileInputStream::CopyingFileInputStream::Skip(int count) {
 
 // ===================================================================
 
+namespace {
+
+// Files with less than this left to read are not mapped: for them, the extra
+// system calls cost more than the copy they would save.
+constexpr int64_t kMinMappedSize = 64 << 10;
+
+constexpr int kDefaultMmapWindowSize = 4 << 20;
+
+}  // namespace
+
+MmapFileInputStream::MmapFileInputStream(int file_descriptor, int window_size)
+    : fallback_(file_descriptor),
+      file_(file_descriptor),
+      window_size_(window_size > 0 ? window_size : kDefaultMmapWindowSize) {
+#ifndef _WIN32
+  struct stat st;
+  if (fstat(file_, &st) != 0 || !S_ISREG(st.st_mode)) return;
+  const off_t offset = lseek(file_, 0, SEEK_CUR);
+  if (offset == (off_t)-1 || st.st_size - offset < kMinMappedSize) return;
+  const long page_size = sysconf(_SC_PAGESIZE);  // NOLINT
+  if (page_size <= 0) return;
+
+  // mmap() requires a page-aligned file offset, so the mapping may start a
+  // little before the stream does.
+  const off_t map_offset = offset - offset % page_size;
+  const uint64_t map_size = static_cast<uint64_t>(st.st_size - map_offset);
+  if (map_size > std::numeric_limits<size_t>::max()) return;
+  void* data = mmap(nullptr, static_cast<size_t>(map_size), PROT_READ,
+                    MAP_PRIVATE, file_, map_offset);
+  if (data == MAP_FAILED) return;
+  madvise(data, static_cast<size_t>(map_size), MADV_SEQUENTIAL);
+
+  data_ = static_cast<char*>(data);
+  page_size_ = static_cast<size_t>(page_size);
+  map_offset_ = map_offset;
+  map_size_ = static_cast<size_t>(map_size);
+  start_ = position_ = static_cast<size_t>(offset - map_offset);
+#endif
+}
+
+MmapFileInputStream::~MmapFileInputStream() { Unmap(); }
+
+bool MmapFileInputStream::Close() {
+  Unmap();
+  return fallback_.Close();
+}
+
+void MmapFileInputStream::Unmap() {
+#ifndef _WIN32
+  if (data_ == nullptr) return;
+  lseek(file_, static_cast<off_t>(map_offset_ + position_), SEEK_SET);
+  if (released_ < map_size_) munmap(data_ + released_, map_size_ - released_);
+  data_ = nullptr;
+#endif
+}
+
+void MmapFileInputStream::ReleaseConsumed() {
+#ifndef _WIN32
+  const size_t end = position_ - position_ % page_size_;
+  if (end <= released_ || end - released_ < static_cast<size_t>(window_size_)) {
+    return;
+  }
+  munmap(data_ + released_, end - released_);
+  released_ = end;
+#endif
+}
+
+bool MmapFileInputStream::Next(const void** data, int* size) {
+  if (data_ == nullptr) return fallback_.Next(data, size);
+  if (position_ >= map_size_) {
+    last_returned_size_ = 0;
+    return false;
+  }
+
+  // Everything before position_ is behind the last buffer BackUp() could
+  // return to, so it can go.
+  ReleaseConsumed();
+
+  const size_t n =
+      std::min(static_cast<size_t>(window_size_), map_size_ - position_);
+  *data = data_ + position_;
+  *size = static_cast<int>(n);
+  position_ += n;
+  last_returned_size_ = static_cast<int>(n);
+
+#ifndef _WIN32
+  // Start reading the next window while the caller works on this one.
+  if (position_ < map_size_) {
+    const size_t ahead = position_ - position_ % page_size_;
+    madvise(data_ + ahead,
+            std::min(map_size_ - ahead,
+                     position_ - ahead + static_cast<size_t>(window_size_)),
+            MADV_WILLNEED);
+  }
+#endif
+  return true;
+}
+
+void MmapFileInputStream::BackUp(int count) {
+  if (data_ == nullptr) return fallback_.BackUp(count);
+  ABSL_CHECK_GT(last_returned_size_, 0)
+      << "BackUp() can only be called after a successful Next().";
+  ABSL_CHECK_LE(count, last_returned_size_);
+  ABSL_CHECK_GE(count, 0);
+  position_ -= count;
+  last_returned_size_ = 0;  // Don't let caller back up further.
+}
+
+bool MmapFileInputStream::Skip(int count) {
+  if (data_ == nullptr) return fallback_.Skip(count);
+  ABSL_CHECK_GE(count, 0);
+  last_returned_size_ = 0;  // Don't let caller back up.
+  if (static_cast<size_t>(count) > map_size_ - position_) {
+    position_ = map_size_;
+    return false;
+  }
+  position_ += count;
+  return true;
+}
+
+int64_t MmapFileInputStream::ByteCount() const {
+  if (data_ == nullptr) return fallback_.ByteCount();
+  return static_cast<int64_t>(position_ - start_);
+}
+
+// ===================================================================
+
 FileOutputStream::FileOutputStream(int file_descriptor, int block_size)
     : CopyingOutputStreamAdaptor(&copying_output_, block_size),
       copying_output_(file_descriptor) {}
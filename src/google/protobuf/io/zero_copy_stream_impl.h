@@ -110,6 +110,76 @@ class PROTOBUF_EXPORT FileInputStream final : public ZeroCopyInputStream {
 
 // ===================================================================
 
+// A ZeroCopyInputStream which reads from a file descriptor by mapping it into
+// memory, so that Next() returns pointers into the page cache rather than into
+// a buffer the data was first copied to.
+//
+// The stream starts at the descriptor's current offset.  The file is mapped
+// in one piece and handed out in windows of `window_size` bytes; the kernel
+// is asked to read ahead of the current window, and windows that have been
+// consumed are unmapped so that resident memory stays bounded.  When the
+// stream is destroyed or closed, the descriptor's offset is moved past the
+// bytes that were consumed.
+//
+// If the descriptor is not a regular file, the file is small, or mapping it
+// fails, the stream transparently falls back to reading it with a
+// FileInputStream.  IsMapped() tells which strategy is in use.
+//
+// WARNING: As with any use of mmap(), if the file is truncated by another
+// process while it is being read, accessing the truncated part raises SIGBUS.
+class PROTOBUF_EXPORT MmapFileInputStream final : public ZeroCopyInputStream {
+ public:
+  explicit MmapFileInputStream(int file_descriptor, int window_size = -1);
+  MmapFileInputStream(const MmapFileInputStream&) = delete;
+  MmapFileInputStream& operator=(const MmapFileInputStream&) = delete;
+  ~MmapFileInputStream() override;
+
+  // Same as FileInputStream.
+  bool Close();
+  void SetCloseOnDelete(bool value) { fallback_.SetCloseOnDelete(value); }
+  int GetErrno() const { return fallback_.GetErrno(); }
+
+  // True if the file is being read through a memory mapping.
+  bool IsMapped() const { return data_ != nullptr; }
+
+  // implements ZeroCopyInputStream ----------------------------------
+  bool Next(const void** data, int* size) override;
+  void BackUp(int count) override;
+  bool Skip(int count) override;
+  int64_t ByteCount() const override;
+
+ private:
+  // Unmaps whatever is still mapped, and moves the descriptor's offset to
+  // the first unconsumed byte.
+  void Unmap();
+
+  // Unmaps the pages before the current position once they add up to at
+  // least one window.
+  void ReleaseConsumed();
+
+  FileInputStream fallback_;
+  const int file_;
+  const int window_size_;
+  size_t page_size_ = 0;
+
+  // The mapping covers [map_offset_, map_offset_ + map_size_) of the file;
+  // its first `released_` bytes have already been unmapped.
+  char* data_ = nullptr;
+  int64_t map_offset_ = 0;
+  size_t map_size_ = 0;
+  size_t released_ = 0;
+
+  // Offsets within the mapping of the first byte of the stream, and of the
+  // next byte Next() will return.
+  size_t start_ = 0;
+  size_t position_ = 0;
+
+  // Size of the last buffer returned by Next(), for BackUp().
+  int last_returned_size_ = 0;
+};
+
+// ===================================================================
+
 // A ZeroCopyOutputStream which writes to a file descriptor.
 //
 // FileOutputStream is preferred over using an ofstream with
@@ -47,6 +47,7 @@
 #include "google/protobuf/testing/file.h"
 #include "google/protobuf/testing/googletest.h"
 #include <gtest/gtest.h>
+#include "absl/crc/crc32c.h"
 #include "absl/log/absl_check.h"
 #include "absl/log/absl_log.h"
 #include "absl/status/status.h"
@@ -54,7 +55,10 @@
 #include "absl/strings/cord_buffer.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/string_view.h"
+#include "google/protobuf/io/async_file_stream.h"
+#include "google/protobuf/io/checksumming_stream.h"
 #include "google/protobuf/io/coded_stream.h"
+#include "google/protobuf/io/gathering_output_stream.h"
 #include "google/protobuf/io/io_win32.h"
 #include "google/protobuf/io/zero_copy_stream_impl.h"
 #include "google/protobuf/test_util2.h"
@@ -62,6 +66,12 @@
 #if HAVE_ZLIB
 #include "google/protobuf/io/gzip_stream.h"
 #endif
+#if HAVE_LZ4
+#include "google/protobuf/io/lz4_stream.h"
+#endif
+#if HAVE_ZSTD
+#include "google/protobuf/io/zstd_stream.h"
+#endif
 
 
 // Must be included last.
@@ -590,6 +600,99 @@ TEST_F(IoTest, CompressionOptions) {
   EXPECT_TRUE(Uncompress(zlib_compressed) == golden);
 }
 
+TEST_F(IoTest, ParallelGzipIo) {
+  const int kBufferSize = 2 * 1024;
+  uint8* buffer = new uint8[kBufferSize];
+  for (auto format : {GzipOutputStream::GZIP, GzipOutputStream::ZLIB}) {
+    for (int i = 0; i < kBlockSizeCount; i++) {
+      for (int j = 0; j < kBlockSizeCount; j++) {
+        for (int z = 0; z < kBlockSizeCount; z++) {
+          int size;
+          {
+            ArrayOutputStream output(buffer, kBufferSize, kBlockSizes[i]);
+            ParallelGzipOutputStream::Options options;
+            options.format = format;
+            options.block_size = kBlockSizes[z];
+            options.num_threads = 2;
+            ParallelGzipOutputStream gzout(&output, options);
+            WriteStuff(&gzout);
+            EXPECT_TRUE(gzout.Close());
+            size = output.ByteCount();
+          }
+          {
+            ArrayInputStream input(buffer, size, kBlockSizes[j]);
+            GzipInputStream gzin(&input, format == GzipOutputStream::GZIP
+                                             ? GzipInputStream::GZIP
+                                             : GzipInputStream::ZLIB);
+            ReadStuff(&gzin);
+          }
+        }
+      }
+    }
+  }
+  delete[] buffer;
+}
+
+TEST_F(IoTest, ParallelGzipIoReadAfterFlush) {
+  std::string compressed;
+  StringOutputStream output(&compressed);
+  ParallelGzipOutputStream::Options options;
+  options.block_size = 7;
+  ParallelGzipOutputStream gzout(&output, options);
+  WriteStuff(&gzout);
+  EXPECT_TRUE(gzout.Flush());
+
+  {
+    ArrayInputStream input(compressed.data(), compressed.size());
+    GzipInputStream gzin(&input, GzipInputStream::GZIP);
+    ReadStuff(&gzin);
+  }
+
+  EXPECT_TRUE(gzout.Close());
+  EXPECT_FALSE(gzout.Flush());
+  EXPECT_EQ(static_cast<int64_t>(Uncompress(compressed).size()),
+            gzout.ByteCount());
+}
+
+TEST_F(IoTest, ParallelGzipLargeInput) {
+  std::string golden_filename =
+      TestUtil::GetTestDataPath("google/protobuf/testdata/golden_message");
+  std::string golden;
+  ABSL_CHECK_OK(File::GetContents(golden_filename, &golden, true));
+  std::string data;
+  for (int i = 0; i < 100; ++i) {
+    absl::StrAppend(&data, golden, i);
+  }
+
+  std::string sequential = Compress(data, GzipOutputStream::Options());
+  for (int max_pending_blocks : {1, 0}) {
+    std::string parallel;
+    {
+      StringOutputStream output(&parallel);
+      ParallelGzipOutputStream::Options options;
+      options.block_size = 16 << 10;
+      options.num_threads = 4;
+      options.max_pending_blocks = max_pending_blocks;
+      ParallelGzipOutputStream gzout(&output, options);
+      WriteToOutput(&gzout, data.data(), data.size());
+    }
+    EXPECT_TRUE(Uncompress(parallel) == data);
+    // Priming each block with the preceding input keeps the output close to
+    // the size of a single deflate stream.
+    EXPECT_LT(parallel.size(), sequential.size() * 11 / 10);
+  }
+}
+
+TEST_F(IoTest, ParallelGzipEmpty) {
+  std::string compressed;
+  {
+    StringOutputStream output(&compressed);
+    ParallelGzipOutputStream gzout(&output);
+  }
+  EXPECT_FALSE(compressed.empty());
+  EXPECT_EQ(Uncompress(compressed), "");
+}
+
 TEST_F(IoTest, TwoSessionWriteGzip) {
   // Test that two concatenated gzip streams can be read correctly
 
@@ -691,6 +794,172 @@ TEST_F(IoTest, GzipInputByteCountAfterClosedConcatenatedStreams) {
 }
 #endif
 
+#if HAVE_ZSTD
+TEST_F(IoTest, ZstdIo) {
+  const int kBufferSize = 2 * 1024;
+  uint8* buffer = new uint8[kBufferSize];
+  for (int i = 0; i < kBlockSizeCount; i++) {
+    for (int j = 0; j < kBlockSizeCount; j++) {
+      for (int z = 0; z < kBlockSizeCount; z++) {
+        int zstd_buffer_size = kBlockSizes[z];
+        int size;
+        {
+          ArrayOutputStream output(buffer, kBufferSize, kBlockSizes[i]);
+          ZstdOutputStream::Options options;
+          if (zstd_buffer_size != -1) {
+            options.buffer_size = zstd_buffer_size;
+          }
+          ZstdOutputStream zout(&output, options);
+          WriteStuff(&zout);
+          EXPECT_TRUE(zout.Close());
+          size = output.ByteCount();
+        }
+        {
+          ArrayInputStream input(buffer, size, kBlockSizes[j]);
+          ZstdInputStream zin(&input, {}, zstd_buffer_size);
+          ReadStuff(&zin);
+          EXPECT_EQ(zin.ZstdErrorMessage(), nullptr);
+        }
+      }
+    }
+  }
+  delete[] buffer;
+}
+
+TEST_F(IoTest, ZstdIoWithDictionary) {
+  const std::string kDictionary = "Hello world! Some text.  Blah blah.";
+  std::string compressed;
+  {
+    StringOutputStream output(&compressed);
+    ZstdOutputStream::Options options;
+    options.compression_level = 19;
+    options.checksum = true;
+    options.dictionary = kDictionary;
+    ZstdOutputStream zout(&output, options);
+    WriteStuff(&zout);
+    EXPECT_TRUE(zout.Close());
+  }
+  {
+    ArrayInputStream input(compressed.data(), compressed.size());
+    ZstdInputStream zin(&input, kDictionary);
+    ReadStuff(&zin);
+  }
+  {
+    // Without the dictionary, decompression fails.
+    ArrayInputStream input(compressed.data(), compressed.size());
+    ZstdInputStream zin(&input);
+    const void* data;
+    int size;
+    while (zin.Next(&data, &size)) {
+    }
+    EXPECT_NE(zin.ZstdErrorMessage(), nullptr);
+  }
+}
+
+TEST_F(IoTest, ZstdIoTruncated) {
+  std::string compressed;
+  {
+    StringOutputStream output(&compressed);
+    ZstdOutputStream zout(&output);
+    WriteStuff(&zout);
+    EXPECT_TRUE(zout.Close());
+  }
+  ArrayInputStream input(compressed.data(), compressed.size() - 1);
+  ZstdInputStream zin(&input);
+  const void* data;
+  int size;
+  while (zin.Next(&data, &size)) {
+  }
+  EXPECT_NE(zin.ZstdErrorMessage(), nullptr);
+}
+
+TEST_F(IoTest, ZstdIoNonPositiveBufferSize) {
+  std::string compressed;
+  {
+    StringOutputStream output(&compressed);
+    ZstdOutputStream zout(&output);
+    WriteStuff(&zout);
+    EXPECT_TRUE(zout.Close());
+  }
+  // Values that are not positive select the default buffer size.
+  for (int buffer_size : {0, -2}) {
+    ArrayInputStream input(compressed.data(), compressed.size());
+    ZstdInputStream zin(&input, {}, buffer_size);
+    ReadStuff(&zin);
+    EXPECT_EQ(zin.ZstdErrorMessage(), nullptr);
+  }
+}
+#endif  // HAVE_ZSTD
+
+#if HAVE_LZ4
+TEST_F(IoTest, Lz4Io) {
+  const int kBufferSize = 2 * 1024;
+  uint8* buffer = new uint8[kBufferSize];
+  for (int i = 0; i < kBlockSizeCount; i++) {
+    for (int j = 0; j < kBlockSizeCount; j++) {
+      for (int z = 0; z < kBlockSizeCount; z++) {
+        int lz4_buffer_size = kBlockSizes[z];
+        int size;
+        {
+          ArrayOutputStream output(buffer, kBufferSize, kBlockSizes[i]);
+          Lz4OutputStream::Options options;
+          if (lz4_buffer_size != -1) {
+            options.buffer_size = lz4_buffer_size;
+          }
+          Lz4OutputStream lz4out(&output, options);
+          WriteStuff(&lz4out);
+          EXPECT_TRUE(lz4out.Close());
+          size = output.ByteCount();
+        }
+        {
+          ArrayInputStream input(buffer, size, kBlockSizes[j]);
+          Lz4InputStream lz4in(&input, {}, lz4_buffer_size);
+          ReadStuff(&lz4in);
+          EXPECT_EQ(lz4in.Lz4ErrorMessage(), nullptr);
+        }
+      }
+    }
+  }
+  delete[] buffer;
+}
+
+TEST_F(IoTest, Lz4IoWithDictionaryAndFlush) {
+  const std::string kDictionary = "Hello world! Some text.  Blah blah.";
+  std::string compressed;
+  {
+    StringOutputStream output(&compressed);
+    Lz4OutputStream::Options options;
+    options.compression_level = 9;
+    options.checksum = true;
+    options.dictionary = kDictionary;
+    Lz4OutputStream lz4out(&output, options);
+    WriteStuff(&lz4out);
+    EXPECT_TRUE(lz4out.Flush());
+    EXPECT_TRUE(lz4out.Close());
+  }
+  ArrayInputStream input(compressed.data(), compressed.size());
+  Lz4InputStream lz4in(&input, kDictionary);
+  ReadStuff(&lz4in);
+}
+
+TEST_F(IoTest, Lz4IoNonPositiveBufferSize) {
+  std::string compressed;
+  {
+    StringOutputStream output(&compressed);
+    Lz4OutputStream lz4out(&output);
+    WriteStuff(&lz4out);
+    EXPECT_TRUE(lz4out.Close());
+  }
+  // Values that are not positive select the default buffer size.
+  for (int buffer_size : {0, -2}) {
+    ArrayInputStream input(compressed.data(), compressed.size());
+    Lz4InputStream lz4in(&input, {}, buffer_size);
+    ReadStuff(&lz4in);
+    EXPECT_EQ(lz4in.Lz4ErrorMessage(), nullptr);
+  }
+}
+#endif  // HAVE_LZ4
+
 // There is no string input, only string output.  Also, it doesn't support
 // explicit block sizes.  So, we'll only run one test and we'll use
 // ArrayInput to read back the results.
@@ -1432,6 +1701,95 @@ TEST_F(IoTest, FileIo) {
   }
 }
 
+TEST_F(IoTest, AsyncFileIo) {
+  std::string filename =
+      absl::StrCat(TestTempDir(), "/zero_copy_stream_test_file");
+
+  for (int i = 0; i < kBlockSizeCount; i++) {
+    for (int j = 0; j < kBlockSizeCount; j++) {
+      for (int buffer_count : {1, 3}) {
+        int file =
+            open(filename.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_BINARY, 0777);
+        ASSERT_GE(file, 0);
+
+        {
+          AsyncFileOutputStream output(file, kBlockSizes[i], buffer_count);
+          WriteStuff(&output);
+          EXPECT_TRUE(output.Flush());
+          EXPECT_EQ(0, output.GetErrno());
+        }
+
+        ASSERT_NE(lseek(file, 0, SEEK_SET), (off_t)-1);
+
+        {
+          AsyncFileInputStream input(file, kBlockSizes[j], buffer_count);
+          ReadStuff(&input);
+          EXPECT_EQ(0, input.GetErrno());
+        }
+
+        close(file);
+      }
+    }
+  }
+}
+
+TEST_F(IoTest, MmapFileIo) {
+  std::string filename =
+      absl::StrCat(TestTempDir(), "/zero_copy_stream_test_file");
+  // Large enough to be mapped, and not a multiple of the page or window size.
+  std::string contents(300001, '\0');
+  for (size_t i = 0; i < contents.size(); ++i) {
+    contents[i] = static_cast<char>('a' + (i * 7 + i / 251) % 26);
+  }
+  int file =
+      open(filename.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_BINARY, 0777);
+  ASSERT_GE(file, 0);
+  {
+    FileOutputStream output(file);
+    WriteString(&output, contents);
+  }
+
+  // Start at an offset that is not page-aligned.
+  constexpr int kStart = 1001;
+  ASSERT_EQ(lseek(file, kStart, SEEK_SET), kStart);
+  {
+    MmapFileInputStream input(file, 10000);
+#ifndef _WIN32
+    EXPECT_TRUE(input.IsMapped());
+#endif
+    std::string read;
+    const void* data;
+    int size;
+    while (input.Next(&data, &size)) {
+      EXPECT_LE(size, 10000);
+      read.append(static_cast<const char*>(data), size);
+      if (read.size() == 50000) {
+        input.BackUp(1000);
+        read.resize(49000);
+        EXPECT_TRUE(input.Skip(2000));
+        read.append(contents, kStart + 49000, 2000);
+      }
+    }
+    EXPECT_EQ(read, contents.substr(kStart));
+    EXPECT_EQ(input.ByteCount(), static_cast<int64_t>(contents.size() - kStart));
+    EXPECT_FALSE(input.Skip(1));
+    EXPECT_EQ(input.GetErrno(), 0);
+  }
+  // The descriptor is left after the consumed data, as if it had been read.
+  EXPECT_EQ(lseek(file, 0, SEEK_CUR), static_cast<off_t>(contents.size()));
+
+  // Files that are too small to map fall back to read().
+  ASSERT_EQ(lseek(file, static_cast<off_t>(contents.size()) - 100, SEEK_SET),
+            static_cast<off_t>(contents.size()) - 100);
+  {
+    MmapFileInputStream input(file);
+    EXPECT_FALSE(input.IsMapped());
+    ReadString(&input, contents.substr(contents.size() - 100));
+    EXPECT_EQ(input.GetErrno(), 0);
+  }
+  close(file);
+}
+
 #ifndef _WIN32
 // This tests the FileInputStream with a non blocking file. It opens a pipe in
 // non blocking mode, then starts reading it. The writing thread starts writing
@@ -1598,6 +1956,264 @@ TEST_F(IoTest, FileWriteError) {
   EXPECT_EQ(EBADF, input.GetErrno());
 }
 
+TEST_F(IoTest, AsyncFileReadError) {
+  MsvcDebugDisabler debug_disabler;
+
+  AsyncFileInputStream input(-1);
+
+  const void* buffer;
+  int size;
+  EXPECT_FALSE(input.Next(&buffer, &size));
+  EXPECT_EQ(EBADF, input.GetErrno());
+}
+
+#ifndef _WIN32
+TEST_F(IoTest, AsyncFileRestoresNonBlocking) {
+  int fd[2];
+  ASSERT_EQ(pipe(fd), 0);
+  ASSERT_EQ(fcntl(fd[0], F_SETFL, O_NONBLOCK), 0);
+  {
+    FileOutputStream output(fd[1]);
+    WriteStuff(&output);
+    ASSERT_TRUE(output.Close());
+  }
+  {
+    AsyncFileInputStream input(fd[0]);
+    EXPECT_EQ(fcntl(fd[0], F_GETFL) & O_NONBLOCK, 0);
+    ReadStuff(&input);
+  }
+  EXPECT_NE(fcntl(fd[0], F_GETFL) & O_NONBLOCK, 0);
+  close(fd[0]);
+}
+#endif
+
+TEST_F(IoTest, AsyncFileWriteError) {
+  MsvcDebugDisabler debug_disabler;
+
+  AsyncFileOutputStream output(-1);
+
+  void* buffer;
+  int size;
+  ASSERT_TRUE(output.Next(&buffer, &size));
+  memset(buffer, 0, size);
+
+  // The write happens on the helper thread; the error surfaces on the next
+  // flush point.
+  EXPECT_FALSE(output.Flush());
+  EXPECT_EQ(EBADF, output.GetErrno());
+  EXPECT_FALSE(output.Next(&buffer, &size));
+}
+
+TEST_F(IoTest, GatheringFileIo) {
+  std::string filename =
+      absl::StrCat(TestTempDir(), "/zero_copy_stream_test_file");
+
+  for (int i = 0; i < kBlockSizeCount; i++) {
+    for (int alias_threshold : {1, 5, 4096}) {
+      int file =
+          open(filename.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_BINARY, 0777);
+      ASSERT_GE(file, 0);
+
+      {
+        GatheringFileOutputStream::Options options;
+        if (kBlockSizes[i] > 0) options.block_size = kBlockSizes[i];
+        options.alias_threshold = alias_threshold;
+        GatheringFileOutputStream output(file, options);
+        WriteStuff(&output);
+        EXPECT_TRUE(output.Flush());
+        EXPECT_EQ(0, output.GetErrno());
+      }
+
+      ASSERT_NE(lseek(file, 0, SEEK_SET), (off_t)-1);
+
+      {
+        FileInputStream input(file);
+        ReadStuff(&input);
+        EXPECT_EQ(0, input.GetErrno());
+      }
+
+      close(file);
+    }
+  }
+}
+
+// Records the gather lists passed to it.
+class RecordingGatheringStream : public GatheringOutputStream {
+ public:
+  bool Write(absl::Span<const absl::string_view> chunks) override {
+    for (absl::string_view chunk : chunks) {
+      pointers.push_back(chunk.data());
+      contents.append(chunk.data(), chunk.size());
+    }
+    ++writes;
+    return true;
+  }
+
+  std::vector<const char*> pointers;
+  std::string contents;
+  int writes = 0;
+};
+
+TEST_F(IoTest, GatheringAliasesLargeWrites) {
+  const std::string small = "small";
+  const std::string large(100000, 'x');
+  absl::Cord cord;
+  cord.Append(std::string(5000, 'a'));
+  cord.Append(std::string(6000, 'b'));
+  std::vector<const char*> cord_pointers;
+  for (absl::string_view chunk : cord.Chunks()) {
+    cord_pointers.push_back(chunk.data());
+  }
+  const absl::Cord small_cord("tiny cord");
+
+  RecordingGatheringStream recorder;
+  {
+    GatheringOutputStreamAdaptor output(&recorder);
+    {
+      CodedOutputStream coded_output(&output);
+      coded_output.EnableAliasing(true);
+      coded_output.WriteRawMaybeAliased(small.data(), small.size());
+      coded_output.WriteRawMaybeAliased(large.data(), large.size());
+      coded_output.WriteCord(cord);
+      coded_output.WriteCord(small_cord);
+      coded_output.WriteRawMaybeAliased(small.data(), small.size());
+    }
+    // The stream holds its own reference to the Cord.
+    cord.Clear();
+    EXPECT_EQ(output.ByteCount(), 10 + 100000 + 11000 + 9);
+    EXPECT_EQ(recorder.writes, 0);
+    EXPECT_TRUE(output.Flush());
+    EXPECT_EQ(recorder.writes, 1);
+  }
+
+  EXPECT_EQ(recorder.contents,
+            absl::StrCat(small, large, std::string(5000, 'a'),
+                         std::string(6000, 'b'), "tiny cord", small));
+  // The large string was referenced, not copied.
+  EXPECT_NE(std::find(recorder.pointers.begin(), recorder.pointers.end(),
+                      large.data()),
+            recorder.pointers.end());
+  // So were the Cord's chunks, while small writes were copied into blocks.
+  for (const char* pointer : cord_pointers) {
+    EXPECT_NE(
+        std::find(recorder.pointers.begin(), recorder.pointers.end(), pointer),
+        recorder.pointers.end());
+  }
+  EXPECT_EQ(recorder.pointers.size(), 3 + cord_pointers.size());
+  EXPECT_EQ(std::find(recorder.pointers.begin(), recorder.pointers.end(),
+                      small.data()),
+            recorder.pointers.end());
+}
+
+TEST_F(IoTest, GatheringFlushThreshold) {
+  const std::string large(10000, 'x');
+  RecordingGatheringStream recorder;
+  GatheringOutputStreamAdaptor::Options options;
+  options.flush_threshold = 25000;
+  GatheringOutputStreamAdaptor output(&recorder, options);
+  for (int i = 0; i < 5; ++i) {
+    EXPECT_TRUE(output.WriteAliasedRaw(large.data(), large.size()));
+  }
+  EXPECT_EQ(recorder.writes, 1);
+  EXPECT_EQ(recorder.contents.size(), 30000);
+  EXPECT_TRUE(output.Flush());
+  EXPECT_EQ(recorder.writes, 2);
+  EXPECT_EQ(recorder.contents, std::string(50000, 'x'));
+  EXPECT_TRUE(output.Flush());
+  EXPECT_EQ(recorder.writes, 2);
+}
+
+TEST_F(IoTest, ChecksummingIo) {
+  const int kBufferSize = 256;
+  uint8_t buffer[kBufferSize];
+
+  for (int i = 0; i < kBlockSizeCount; i++) {
+    for (int j = 0; j < kBlockSizeCount; j++) {
+      int size;
+      uint32_t crc;
+      {
+        ArrayOutputStream raw_output(buffer, kBufferSize, kBlockSizes[i]);
+        ChecksummingOutputStream output(&raw_output);
+        size = WriteStuff(&output);
+        crc = output.Checksum();
+      }
+      absl::string_view written(reinterpret_cast<char*>(buffer), size);
+      EXPECT_EQ(crc, static_cast<uint32_t>(absl::ComputeCrc32c(written)));
+      {
+        // ReadStuff() backs up and skips; skipped bytes are checksummed too.
+        ArrayInputStream raw_input(buffer, size, kBlockSizes[j]);
+        ChecksummingInputStream input(&raw_input);
+        ReadStuff(&input);
+        EXPECT_EQ(input.Checksum(), crc);
+      }
+    }
+  }
+}
+
+TEST_F(IoTest, ChecksummingResetChecksum) {
+  std::string output_str;
+  StringOutputStream raw_output(&output_str);
+  ChecksummingOutputStream output(&raw_output);
+  WriteString(&output, "first record");
+  uint32_t first = output.Checksum();
+  output.ResetChecksum();
+  WriteString(&output, "second record");
+  uint32_t second = output.Checksum();
+  EXPECT_EQ(first, static_cast<uint32_t>(absl::ComputeCrc32c("first record")));
+  EXPECT_EQ(second,
+            static_cast<uint32_t>(absl::ComputeCrc32c("second record")));
+
+  ArrayInputStream raw_input(output_str.data(), output_str.size(), 5);
+  ChecksummingInputStream input(&raw_input);
+  ReadString(&input, "first record");
+  EXPECT_EQ(input.Checksum(), first);
+  input.ResetChecksum();
+  ReadString(&input, "second record");
+  EXPECT_EQ(input.Checksum(), second);
+}
+
+TEST_F(IoTest, ChecksummingCords) {
+  const std::string data(10000, 'x');
+  absl::Cord cord;
+  cord.Append(data.substr(0, 6000));
+  cord.Append(data.substr(6000));
+  const uint32_t crc = static_cast<uint32_t>(
+      absl::ComputeCrc32c(absl::StrCat("head", data)));
+
+  CordOutputStream raw_output;
+  {
+    ChecksummingOutputStream output(&raw_output);
+    WriteString(&output, "head");
+    EXPECT_TRUE(output.WriteCord(cord));
+    EXPECT_EQ(output.Checksum(), crc);
+  }
+  absl::Cord result = raw_output.Consume();
+  EXPECT_EQ(result, absl::StrCat("head", data));
+
+  CordInputStream raw_input(&result);
+  ChecksummingInputStream input(&raw_input);
+  ReadString(&input, "head");
+  absl::Cord read;
+  EXPECT_TRUE(input.ReadCord(&read, data.size()));
+  EXPECT_EQ(read, data);
+  EXPECT_EQ(input.Checksum(), crc);
+}
+
+TEST_F(IoTest, GatheringFileWriteError) {
+  MsvcDebugDisabler debug_disabler;
+
+  GatheringFileOutputStream output(-1);
+
+  void* buffer;
+  int size;
+  ASSERT_TRUE(output.Next(&buffer, &size));
+  memset(buffer, 0, size);
+
+  EXPECT_FALSE(output.Flush());
+  EXPECT_EQ(EBADF, output.GetErrno());
+  EXPECT_FALSE(output.Next(&buffer, &size));
+}
+
 // Pipes are not seekable, so File{Input,Output}Stream ends up doing some
 // different things to handle them.  We'll test by writing to a pipe and
 // reading back from it.
@@ -0,0 +1,227 @@
+// Protocol Buffers - Google's data interchange format
+// Copyright 2008 Google Inc.  All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+// This file contains the implementation of classes ZstdInputStream and
+// ZstdOutputStream.
+
+#if HAVE_ZSTD
+#include "google/protobuf/io/zstd_stream.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+#include "absl/log/absl_check.h"
+#include "absl/strings/string_view.h"
+#include "google/protobuf/port.h"
+#include "zstd.h"
+#include "zstd_errors.h"
+
+namespace google {
+namespace protobuf {
+namespace io {
+
+namespace {
+
+constexpr int kDefaultBufferSize = 65536;
+
+// Zstd reports errors as size_t values for which ZSTD_isError() is true.
+constexpr size_t MakeError(ZSTD_ErrorCode code) {
+  return static_cast<size_t>(0) - static_cast<size_t>(code);
+}
+
+}  // namespace
+
+ZstdInputStream::ZstdInputStream(ZeroCopyInputStream* sub_stream,
+                                 absl::string_view dictionary, int buffer_size)
+    : sub_stream_(sub_stream), dctx_(ZSTD_createDCtx()) {
+  ABSL_CHECK(dctx_ != nullptr);
+  output_buffer_length_ = buffer_size > 0 ? buffer_size : kDefaultBufferSize;
+  output_buffer_ = static_cast<char*>(operator new(output_buffer_length_));
+  output_position_ = output_end_ = output_buffer_;
+  if (!dictionary.empty()) {
+    zerror_ = ZSTD_DCtx_loadDictionary(dctx_, dictionary.data(),
+                                       dictionary.size());
+    if (!ZSTD_isError(zerror_)) zerror_ = 0;
+  }
+}
+
+ZstdInputStream::~ZstdInputStream() {
+  internal::SizedDelete(output_buffer_, output_buffer_length_);
+  ZSTD_freeDCtx(dctx_);
+}
+
+const char* ZstdInputStream::ZstdErrorMessage() const {
+  return zerror_ == 0 ? nullptr : ZSTD_getErrorName(zerror_);
+}
+
+bool ZstdInputStream::Decompress() {
+  ZSTD_outBuffer output = {output_buffer_, output_buffer_length_, 0};
+  while (output.pos == 0) {
+    if (input_.pos == input_.size && !output_pending_) {
+      const void* data;
+      int size;
+      if (!sub_stream_->Next(&data, &size)) {
+        if (!frame_done_) zerror_ = MakeError(ZSTD_error_srcSize_wrong);
+        return false;
+      }
+      input_ = {data, static_cast<size_t>(size), 0};
+      if (size == 0) continue;
+    }
+    const size_t result = ZSTD_decompressStream(dctx_, &output, &input_);
+    if (ZSTD_isError(result)) {
+      zerror_ = result;
+      return false;
+    }
+    frame_done_ = result == 0;
+    // A finished frame has been fully flushed, even if it filled the buffer.
+    output_pending_ = !frame_done_ && output.pos == output.size;
+  }
+  output_position_ = output_buffer_;
+  output_end_ = output_buffer_ + output.pos;
+  return true;
+}
+
+// implements ZeroCopyInputStream ----------------------------------
+bool ZstdInputStream::Next(const void** data, int* size) {
+  if (zerror_ != 0) return false;
+  if (output_position_ == output_end_ && !Decompress()) return false;
+  *data = output_position_;
+  *size = static_cast<int>(output_end_ - output_position_);
+  byte_count_ += *size;
+  output_position_ = output_end_;
+  return true;
+}
+
+void ZstdInputStream::BackUp(int count) {
+  ABSL_CHECK_GE(count, 0);
+  ABSL_CHECK_LE(count, output_position_ - output_buffer_);
+  output_position_ -= count;
+  byte_count_ -= count;
+}
+
+bool ZstdInputStream::Skip(int count) {
+  const void* data;
+  int size = 0;
+  bool ok = Next(&data, &size);
+  while (ok && (size < count)) {
+    count -= size;
+    ok = Next(&data, &size);
+  }
+  if (size > count) {
+    BackUp(size - count);
+  }
+  return ok;
+}
+
+// =========================================================================
+
+ZstdOutputStream::ZstdOutputStream(ZeroCopyOutputStream* sub_stream)
+    : ZstdOutputStream(sub_stream, Options()) {}
+
+ZstdOutputStream::ZstdOutputStream(ZeroCopyOutputStream* sub_stream,
+                                   const Options& options)
+    : sub_stream_(sub_stream), cctx_(ZSTD_createCCtx()) {
+  ABSL_CHECK(cctx_ != nullptr);
+  input_buffer_length_ =
+      options.buffer_size > 0 ? options.buffer_size : kDefaultBufferSize;
+  input_buffer_ = static_cast<char*>(operator new(input_buffer_length_));
+
+  zerror_ = ZSTD_CCtx_setParameter(cctx_, ZSTD_c_compressionLevel,
+                                   options.compression_level);
+  if (!ZSTD_isError(zerror_)) {
+    zerror_ = ZSTD_CCtx_setParameter(cctx_, ZSTD_c_checksumFlag,
+                                     options.checksum ? 1 : 0);
+  }
+  if (!ZSTD_isError(zerror_) && !options.dictionary.empty()) {
+    zerror_ = ZSTD_CCtx_loadDictionary(cctx_, options.dictionary.data(),
+                                       options.dictionary.size());
+  }
+  if (!ZSTD_isError(zerror_)) zerror_ = 0;
+}
+
+ZstdOutputStream::~ZstdOutputStream() {
+  Close();
+  internal::SizedDelete(input_buffer_, input_buffer_length_);
+  ZSTD_freeCCtx(cctx_);
+}
+
+const char* ZstdOutputStream::ZstdErrorMessage() const {
+  return zerror_ == 0 ? nullptr : ZSTD_getErrorName(zerror_);
+}
+
+// private
+bool ZstdOutputStream::Compress(ZSTD_EndDirective mode) {
+  ZSTD_inBuffer input = {input_buffer_, input_used_, 0};
+  for (;;) {
+    if (output_.pos == output_.size) {
+      void* data;
+      int size;
+      if (!sub_stream_->Next(&data, &size)) {
+        output_ = {nullptr, 0, 0};
+        zerror_ = MakeError(ZSTD_error_dstSize_tooSmall);
+        return false;
+      }
+      output_ = {data, static_cast<size_t>(size), 0};
+    }
+    const size_t remaining =
+        ZSTD_compressStream2(cctx_, &output_, &input, mode);
+    if (ZSTD_isError(remaining)) {
+      zerror_ = remaining;
+      return false;
+    }
+    // With ZSTD_e_continue, compression is done once all input has been
+    // taken; otherwise, once everything has been written out.
+    if (mode == ZSTD_e_continue ? input.pos == input.size : remaining == 0) {
+      break;
+    }
+  }
+  input_used_ = 0;
+  if (mode != ZSTD_e_continue) {
+    // Notify lower layer of data.
+    sub_stream_->BackUp(static_cast<int>(output_.size - output_.pos));
+    // We don't own the buffer anymore.
+    output_ = {nullptr, 0, 0};
+  }
+  return true;
+}
+
+// implements ZeroCopyOutputStream ---------------------------------
+bool ZstdOutputStream::Next(void** data, int* size) {
+  if (zerror_ != 0 || closed_) return false;
+  if (input_used_ != 0 && !Compress(ZSTD_e_continue)) return false;
+  input_used_ = input_buffer_length_;
+  byte_count_ += input_buffer_length_;
+  *data = input_buffer_;
+  *size = static_cast<int>(input_buffer_length_);
+  return true;
+}
+
+void ZstdOutputStream::BackUp(int count) {
+  ABSL_CHECK_GE(count, 0);
+  ABSL_CHECK_LE(static_cast<size_t>(count), input_used_);
+  input_used_ -= count;
+  byte_count_ -= count;
+}
+
+bool ZstdOutputStream::Flush() {
+  if (zerror_ != 0 || closed_) return false;
+  return Compress(ZSTD_e_flush);
+}
+
+bool ZstdOutputStream::Close() {
+  if (closed_) return zerror_ == 0;
+  closed_ = true;
+  if (zerror_ != 0) return false;
+  return Compress(ZSTD_e_end);
+}
+
+}  // namespace io
+}  // namespace protobuf
+}  // namespace google
+
+#endif  // HAVE_ZSTD
@@ -0,0 +1,161 @@
+// Protocol Buffers - Google's data interchange format
+// Copyright 2008 Google Inc.  All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+// This file contains the definition for classes ZstdInputStream and
+// ZstdOutputStream, which are analogous to GzipInputStream and
+// GzipOutputStream but use the Zstandard format, which decompresses several
+// times faster than zlib at comparable ratios.
+//
+// Both can use a dictionary (see ZDICT_trainFromBuffer() in zdict.h), which
+// greatly improves the ratio for small messages that share a schema.
+
+#ifndef GOOGLE_PROTOBUF_IO_ZSTD_STREAM_H__
+#define GOOGLE_PROTOBUF_IO_ZSTD_STREAM_H__
+
+#include <cstddef>
+#include <cstdint>
+
+#include "absl/strings/string_view.h"
+#include "google/protobuf/io/zero_copy_stream.h"
+#include "zstd.h"
+
+// Must be included last.
+#include "google/protobuf/port_def.inc"
+
+namespace google {
+namespace protobuf {
+namespace io {
+
+// A ZeroCopyInputStream that decompresses Zstandard data read from another
+// stream.  Concatenated frames are decompressed as one stream.
+class PROTOBUF_EXPORT ZstdInputStream final : public ZeroCopyInputStream {
+ public:
+  // If the data was compressed with a dictionary, `dictionary` must hold the
+  // same dictionary; it is copied.  A buffer_size of -1, or any other value
+  // that is not positive, selects a default of 64kB.
+  explicit ZstdInputStream(ZeroCopyInputStream* sub_stream,
+                           absl::string_view dictionary = {},
+                           int buffer_size = -1);
+  ZstdInputStream(const ZstdInputStream&) = delete;
+  ZstdInputStream& operator=(const ZstdInputStream&) = delete;
+  ~ZstdInputStream() override;
+
+  // Return last error message or NULL if no error.
+  const char* ZstdErrorMessage() const;
+  // Zstd error code of the last error, or 0.  A stream that ends in the middle
+  // of a frame reports ZSTD_error_srcSize_wrong.
+  size_t ZstdErrorCode() const { return zerror_; }
+
+  // implements ZeroCopyInputStream ----------------------------------
+  bool Next(const void** data, int* size) override;
+  void BackUp(int count) override;
+  bool Skip(int count) override;
+  int64_t ByteCount() const override { return byte_count_; }
+
+ private:
+  // Decompresses into the output buffer.  Returns false at the end of the
+  // stream or on error.
+  bool Decompress();
+
+  ZeroCopyInputStream* sub_stream_;
+  ZSTD_DCtx* dctx_;
+  size_t zerror_ = 0;
+
+  // Compressed data from sub_stream_ that has not been decompressed yet.
+  ZSTD_inBuffer input_ = {nullptr, 0, 0};
+  // True if the last call to ZSTD_decompressStream() filled the output buffer
+  // and may have more output pending.
+  bool output_pending_ = false;
+  // True if the input seen so far ends at a frame boundary.
+  bool frame_done_ = true;
+
+  char* output_buffer_;
+  size_t output_buffer_length_;
+  // [output_position_, output_end_) has been decompressed but not returned.
+  char* output_position_;
+  char* output_end_;
+  int64_t byte_count_ = 0;
+};
+
+// A ZeroCopyOutputStream that compresses data to another stream in the
+// Zstandard format.
+class PROTOBUF_EXPORT ZstdOutputStream final : public ZeroCopyOutputStream {
+ public:
+  struct PROTOBUF_EXPORT Options {
+    // What size buffer to use internally.  Defaults to 64kB.
+    int buffer_size = 64 * 1024;
+
+    // Usually between 1 and ZSTD_maxCLevel(), where higher levels compress
+    // better but more slowly; negative levels trade ratio for more speed.
+    // Defaults to ZSTD_CLEVEL_DEFAULT.
+    int compression_level = ZSTD_CLEVEL_DEFAULT;
+
+    // Whether to append a checksum of the uncompressed data to each frame.
+    bool checksum = false;
+
+    // Optional dictionary to compress with; the same one must be passed to
+    // ZstdInputStream.  It is copied.
+    absl::string_view dictionary;
+  };
+
+  // Create a ZstdOutputStream with default options.
+  explicit ZstdOutputStream(ZeroCopyOutputStream* sub_stream);
+
+  // Create a ZstdOutputStream with the given options.
+  ZstdOutputStream(ZeroCopyOutputStream* sub_stream, const Options& options);
+  ZstdOutputStream(const ZstdOutputStream&) = delete;
+  ZstdOutputStream& operator=(const ZstdOutputStream&) = delete;
+
+  ~ZstdOutputStream() override;
+
+  // Return last error message or NULL if no error.
+  const char* ZstdErrorMessage() const;
+  size_t ZstdErrorCode() const { return zerror_; }
+
+  // Flushes data written so far to compressed data in the underlying stream,
+  // so that a reader can decompress everything written before the flush.
+  // It is the caller's responsibility to flush the underlying stream if
+  // necessary.  Returns true if no error.
+  bool Flush();
+
+  // Writes out all data and ends the frame.  It is the caller's
+  // responsibility to close the underlying stream if necessary.
+  // Returns true if no error.
+  bool Close();
+
+  // implements ZeroCopyOutputStream ---------------------------------
+  bool Next(void** data, int* size) override;
+  void BackUp(int count) override;
+  int64_t ByteCount() const override { return byte_count_; }
+
+ private:
+  // Compresses the input buffer into sub_stream_.
+  bool Compress(ZSTD_EndDirective mode);
+
+  ZeroCopyOutputStream* sub_stream_;
+  ZSTD_CCtx* cctx_;
+  size_t zerror_ = 0;
+  bool closed_ = false;
+
+  // Result from calling Next() on sub_stream_; the first pos bytes hold
+  // compressed data.
+  ZSTD_outBuffer output_ = {nullptr, 0, 0};
+
+  char* input_buffer_;
+  size_t input_buffer_length_;
+  // The first input_used_ bytes of input_buffer_ hold data to compress.
+  size_t input_used_ = 0;
+  int64_t byte_count_ = 0;
+};
+
+}  // namespace io
+}  // namespace protobuf
+}  // namespace google
+
+#include "google/protobuf/port_undef.inc"
+
+#endif  // GOOGLE_PROTOBUF_IO_ZSTD_STREAM_H__
@@ -19,6 +19,7 @@
 #include <type_traits>
 #include <utility>
 
+#include "absl/algorithm/container.h"
 #include "absl/log/absl_check.h"
 #include "absl/log/absl_log.h"
 #include "absl/status/status.h"
@@ -473,10 +474,14 @@ absl::Status WriteFields(JsonWriter& writer, const Msg<Traits>& msg,
   // Add extensions *before* sorting.
   Traits::FindAndAppendExtensions(msg, fields);
 
-  // Fields are guaranteed to be serialized in field number order.
-  absl::c_sort(fields, [](const auto& a, const auto& b) {
+  // Fields are guaranteed to be serialized in field number order. They are
+  // usually declared in that order too, in which case we can skip the sort.
+  auto by_number = [](const auto& a, const auto& b) {
     return Traits::FieldNumber(a) < Traits::FieldNumber(b);
-  });
+  };
+  if (!absl::c_is_sorted(fields, by_number)) {
+    absl::c_sort(fields, by_number);
+  }
 
   for (auto field : fields) {
     RETURN_IF_ERROR(WriteField<Traits>(writer, msg, field, first));
@@ -60,6 +60,12 @@ struct UnparseProto2Descriptor : Proto2Descriptor {
     // fields to write, because the way that JSON decides to print non-extension
     // fields is slightly subtle. That logic is handled elsewhere; we're only
     // here to get extensions.
+    //
+    // Most messages declare no extension ranges; for those, skip ListFields(),
+    // which would otherwise visit every field a second time.
+    if (msg.GetDescriptor()->extension_range_count() == 0) {
+      return;
+    }
     std::vector<Field> all_fields;
     msg.GetReflection()->ListFields(msg, &all_fields);
 
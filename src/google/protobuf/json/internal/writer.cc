@@ -266,8 +266,27 @@ static bool MustEscape(uint32_t scalar, absl::string_view& custom_escape) {
   }
 }
 
+// Returns whether `c` is a printable ASCII character that MustEscape() would
+// let through unchanged.
+static bool IsUnescapedAscii(char c) {
+  return c >= 0x20 && c < 0x7f && c != '"' && c != '\\' && c != '<' &&
+         c != '>';
+}
+
 void JsonWriter::WriteEscapedUtf8(absl::string_view str) {
   while (!str.empty()) {
+    // Field names and most string values are plain ASCII; hand whole runs of
+    // it to the sink at once instead of one scalar at a time.
+    size_t run = 0;
+    while (run < str.size() && IsUnescapedAscii(str[run])) {
+      ++run;
+    }
+    if (run != 0) {
+      Write(str.substr(0, run));
+      str.remove_prefix(run);
+      continue;
+    }
+
     auto scalar = ConsumeUtf8Scalar(str);
     absl::string_view custom_escape;
 
@@ -1308,6 +1308,15 @@ TEST_P(JsonTest, HtmlEscape) {
           R"("\"\u003cscript\u003ealert('hello!);\u003c/script\u003e":0})"));
 }
 
+TEST_P(JsonTest, EscapeInsideAsciiRuns) {
+  TestMessage m;
+  m.set_string_value("plain \"quoted\"\ttab\\ caf\xc3\xa9 \x7f end");
+  EXPECT_THAT(ToJson(m),
+              IsOkAndHolds(R"({"stringValue":"plain \"quoted\"\ttab\\ caf)"
+                           "\xc3\xa9"
+                           R"( \u007f end"})"));
+}
+
 TEST_P(JsonTest, FieldOrder) {
   // $ protoscope -s <<< "3: 3 22: 2 1: 1 22: 2"
   std::string out;
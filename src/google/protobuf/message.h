@@ -99,6 +99,7 @@
 #include "absl/log/absl_check.h"
 #include "absl/strings/cord.h"
 #include "absl/strings/string_view.h"
+#include "absl/types/span.h"
 #include "google/protobuf/arena.h"
 #include "google/protobuf/descriptor.h"
 #include "google/protobuf/generated_message_reflection.h"
@@ -123,6 +124,8 @@ namespace protobuf {
 class Message;
 class Reflection;
 class MessageFactory;
+template <typename T>
+class ScalarFieldAccessor;
 
 // Defined in other files.
 class AssignDescriptorsHelper;
@@ -821,6 +824,18 @@ class PROTOBUF_EXPORT Reflection final {
   MutableRepeatedFieldRef<T> GetMutableRepeatedFieldRef(
       Message* message, const FieldDescriptor* field) const;
 
+  // Returns an accessor that reads the singular scalar `field` from messages
+  // of this type.  The field is validated and located once, up front, so
+  // reading it through the accessor skips the checks that Get*() repeats on
+  // every call.  Useful when the same field is read from many messages.
+  //
+  // T must match field->cpp_type() as for GetRepeatedFieldRef(), except that
+  // enum fields must be read as int32_t (the value GetEnumValue() returns).
+  // The accessor must not outlive this Reflection.
+  template <typename T>
+  ScalarFieldAccessor<T> GetScalarFieldAccessor(
+      const FieldDescriptor* field) const;
+
   // DEPRECATED. Please use Get(Mutable)RepeatedFieldRef() for repeated field
   // access. The following repeated field accessors will be removed in the
   // future.
@@ -1019,6 +1034,8 @@ class PROTOBUF_EXPORT Reflection final {
   friend class RepeatedFieldRef;
   template <typename T, typename Enable>
   friend class MutableRepeatedFieldRef;
+  template <typename T>
+  friend class ScalarFieldAccessor;
   friend class Message;
   friend class MessageLayoutInspector;
   friend class AssignDescriptorsHelper;
@@ -1249,6 +1266,111 @@ class PROTOBUF_EXPORT Reflection final {
                                              internal::ParseContext* ctx);
 };
 
+// Reads one singular scalar field from messages of a single type.  Obtained
+// from Reflection::GetScalarFieldAccessor().
+//
+// Fields stored directly in the message object are read from their resolved
+// offset.  Extensions, oneof members and split fields go through the regular
+// Reflection getters instead, so every field is supported.
+template <typename T>
+class ScalarFieldAccessor {
+  static_assert(internal::PrimitiveTraits<T>::is_primitive,
+                "ScalarFieldAccessor only supports scalar types.");
+
+ public:
+  // Returns the field's value in `message`, which must be of the type the
+  // accessor was created for.
+  T Get(const Message& message) const {
+    if (PROTOBUF_PREDICT_TRUE(direct_)) {
+      return internal::GetConstRefAtOffset<T>(message, offset_);
+    }
+    return GetSlow(message);
+  }
+
+  // Equivalent to Reflection::HasField(message, field()), but reads the
+  // precomputed hasbit when the field has one.
+  bool Has(const Message& message) const {
+    if (PROTOBUF_PREDICT_TRUE(has_bit_index_ != kNoHasBit)) {
+      const uint32_t* has_bits =
+          &internal::GetConstRefAtOffset<uint32_t>(message, has_bits_offset_);
+      return (has_bits[has_bit_index_ / 32] >> (has_bit_index_ % 32)) & 1;
+    }
+    return reflection_->HasField(message, field_);
+  }
+
+  // Reads the field from each of `messages` into the corresponding element of
+  // `output`, which must have room for `messages.size()` values.
+  void GetBatch(absl::Span<const Message* const> messages, T* output) const {
+    if (direct_) {
+      for (const Message* message : messages) {
+        *output++ = internal::GetConstRefAtOffset<T>(*message, offset_);
+      }
+    } else {
+      for (const Message* message : messages) *output++ = GetSlow(*message);
+    }
+  }
+
+  const FieldDescriptor* field() const { return field_; }
+
+ private:
+  friend class Reflection;
+
+  ScalarFieldAccessor(const Reflection* reflection,
+                      const FieldDescriptor* field)
+      : reflection_(reflection), field_(field) {
+    const FieldDescriptor::CppType cpp_type =
+        field->cpp_type() == FieldDescriptor::CPPTYPE_ENUM
+            ? FieldDescriptor::CPPTYPE_INT32
+            : field->cpp_type();
+    ABSL_CHECK_EQ(field->containing_type(), reflection->descriptor_)
+        << "Field does not match message type: " << field->full_name();
+    ABSL_CHECK(!field->is_repeated())
+        << "Field is repeated: " << field->full_name();
+    ABSL_CHECK_EQ(cpp_type, internal::PrimitiveTraits<T>::cpp_type)
+        << "Field has the wrong type: " << field->full_name();
+    direct_ = !field->is_extension() &&
+              !reflection->schema_.InRealOneof(field) &&
+              !reflection->schema_.IsSplit(field);
+    if (direct_) offset_ = reflection->schema_.GetFieldOffsetNonOneof(field);
+    if (direct_ && reflection->schema_.HasHasbits()) {
+      has_bit_index_ = reflection->schema_.HasBitIndex(field);
+      has_bits_offset_ = reflection->schema_.HasBitsOffset();
+    }
+  }
+
+  T GetSlow(const Message& message) const {
+    switch (field_->cpp_type()) {
+      case FieldDescriptor::CPPTYPE_INT32:
+        return static_cast<T>(reflection_->GetInt32(message, field_));
+      case FieldDescriptor::CPPTYPE_INT64:
+        return static_cast<T>(reflection_->GetInt64(message, field_));
+      case FieldDescriptor::CPPTYPE_UINT32:
+        return static_cast<T>(reflection_->GetUInt32(message, field_));
+      case FieldDescriptor::CPPTYPE_UINT64:
+        return static_cast<T>(reflection_->GetUInt64(message, field_));
+      case FieldDescriptor::CPPTYPE_FLOAT:
+        return static_cast<T>(reflection_->GetFloat(message, field_));
+      case FieldDescriptor::CPPTYPE_DOUBLE:
+        return static_cast<T>(reflection_->GetDouble(message, field_));
+      case FieldDescriptor::CPPTYPE_BOOL:
+        return static_cast<T>(reflection_->GetBool(message, field_));
+      case FieldDescriptor::CPPTYPE_ENUM:
+        return static_cast<T>(reflection_->GetEnumValue(message, field_));
+      default:
+        internal::Unreachable();
+    }
+  }
+
+  static constexpr uint32_t kNoHasBit = static_cast<uint32_t>(-1);
+
+  const Reflection* reflection_;
+  const FieldDescriptor* field_;
+  bool direct_ = false;
+  uint32_t offset_ = 0;
+  uint32_t has_bit_index_ = kNoHasBit;
+  uint32_t has_bits_offset_ = 0;
+};
+
 // Abstract interface for a factory for message objects.
 //
 // The thread safety for this class is implementation dependent, see comments
@@ -1572,6 +1694,12 @@ MutableRepeatedFieldRef<T> Reflection::GetMutableRepeatedFieldRef(
     Message* message, const FieldDescriptor* field) const {
   return MutableRepeatedFieldRef<T>(message, field);
 }
+
+template <typename T>
+ScalarFieldAccessor<T> Reflection::GetScalarFieldAccessor(
+    const FieldDescriptor* field) const {
+  return ScalarFieldAccessor<T>(this, field);
+}
 }  // namespace protobuf
 }  // namespace google
 
@@ -288,12 +288,12 @@ bool MessageLite::ParsePartialFromZeroCopyStream(
 }
 
 bool MessageLite::ParseFromFileDescriptor(int file_descriptor) {
-  io::FileInputStream input(file_descriptor);
+  io::MmapFileInputStream input(file_descriptor);
   return ParseFromZeroCopyStream(&input) && input.GetErrno() == 0;
 }
 
 bool MessageLite::ParsePartialFromFileDescriptor(int file_descriptor) {
-  io::FileInputStream input(file_descriptor);
+  io::MmapFileInputStream input(file_descriptor);
   return ParsePartialFromZeroCopyStream(&input) && input.GetErrno() == 0;
 }
 
@@ -293,7 +293,8 @@ class PROTOBUF_EXPORT MessageLite {
   ABSL_ATTRIBUTE_REINITIALIZES bool ParsePartialFromZeroCopyStream(
       io::ZeroCopyInputStream* input);
   // Parse a protocol buffer from a file descriptor.  If successful, the entire
-  // input will be consumed.
+  // input will be consumed.  Large regular files are memory-mapped rather than
+  // copied (see io::MmapFileInputStream).
   ABSL_ATTRIBUTE_REINITIALIZES bool ParseFromFileDescriptor(
       int file_descriptor);
   // Like ParseFromFileDescriptor(), but accepts messages that are missing
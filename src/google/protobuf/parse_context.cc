@@ -232,29 +232,38 @@ const char* EpsCopyInputStream::ReadCordFallback(const char* ptr, int size,
   if (bytes_from_buffer > kPatchBufferSize || !in_patch_buf) {
     cord->Clear();
     StreamBackUp(bytes_from_buffer);
-  } else if (bytes_from_buffer == kSlopBytes && next_chunk_ != nullptr &&
+  } else if (next_chunk_ != nullptr &&
              // Only backup if next_chunk_ points to a valid buffer returned by
              // ZeroCopyInputStream. This happens when NextStream() returns a
              // chunk that's smaller than or equal to kSlopBytes.
              next_chunk_ != patch_buffer_) {
-    cord->Clear();
-    StreamBackUp(size_);
+    // The patch buffer holds the last kSlopBytes of the previous chunk
+    // followed by the start of next_chunk_, which is the last buffer returned
+    // by ZeroCopyInputStream.  Copy only the bytes from the previous chunk and
+    // read the rest from the stream, so that e.g. CordInputStream can share
+    // them with its source.
+    ABSL_DCHECK(size_ > kSlopBytes);
+    int prefix = static_cast<int>(buffer_end_ - ptr);
+    if (prefix > 0) {
+      size -= prefix;
+      ABSL_DCHECK_GT(size, 0);
+      *cord = absl::string_view(ptr, prefix);
+      StreamBackUp(size_);
+    } else {
+      cord->Clear();
+      StreamBackUp(size_ + prefix);
+    }
   } else {
     size -= bytes_from_buffer;
     ABSL_DCHECK_GT(size, 0);
     *cord = absl::string_view(ptr, bytes_from_buffer);
-    if (next_chunk_ == patch_buffer_) {
-      // We have read to end of the last buffer returned by
-      // ZeroCopyInputStream. So the stream is in the right position.
-    } else if (next_chunk_ == nullptr) {
+    if (next_chunk_ == nullptr) {
       // There is no remaining chunks. We can't read size.
       SetEndOfStream();
       return nullptr;
-    } else {
-      // Next chunk is already loaded
-      ABSL_DCHECK(size_ > kSlopBytes);
-      StreamBackUp(size_ - kSlopBytes);
     }
+    // We have read to end of the last buffer returned by
+    // ZeroCopyInputStream. So the stream is in the right position.
   }
   if (size > overall_limit_) return nullptr;
   overall_limit_ -= size;
@@ -19,6 +19,7 @@
 #include <climits>
 #include <cmath>
 #include <cstddef>
+#include <cstring>
 #include <limits>
 #include <string>
 #include <utility>
@@ -32,6 +33,7 @@
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_join.h"
 #include "absl/strings/string_view.h"
+#include "absl/strings/strip.h"
 #include "google/protobuf/any.h"
 #include "google/protobuf/descriptor.h"
 #include "google/protobuf/descriptor.pb.h"
@@ -504,9 +506,12 @@ class TextFormat::Parser::ParserImpl {
     int start_line = tokenizer_.current().line;
     int start_column = tokenizer_.current().column;
 
+    // Check for "[" first: it is much cheaper than the Any type check and most
+    // fields are neither extensions nor expanded Any values.
     const FieldDescriptor* any_type_url_field;
     const FieldDescriptor* any_value_field;
-    if (internal::GetAnyFieldDescriptors(*message, &any_type_url_field,
+    if (LookingAt("[") &&
+        internal::GetAnyFieldDescriptors(*message, &any_type_url_field,
                                          &any_value_field) &&
         TryConsume("[")) {
       std::string full_type_name, prefix;
@@ -1073,7 +1078,7 @@ class TextFormat::Parser::ParserImpl {
   }
 
   // Returns true if the current token's text is equal to that specified.
-  bool LookingAt(const std::string& text) {
+  bool LookingAt(absl::string_view text) {
     return tokenizer_.current().text == text;
   }
 
@@ -1342,7 +1347,7 @@ class TextFormat::Parser::ParserImpl {
   // Consumes a token and confirms that it matches that specified in the
   // value parameter. Returns false if the token found does not match that
   // which was specified.
-  bool Consume(const std::string& value) {
+  bool Consume(absl::string_view value) {
     const std::string& current_value = tokenizer_.current().text;
 
     if (current_value != value) {
@@ -1358,7 +1363,7 @@ class TextFormat::Parser::ParserImpl {
 
   // Similar to `Consume`, but the following token may be tokenized as
   // TYPE_WHITESPACE.
-  bool ConsumeBeforeWhitespace(const std::string& value) {
+  bool ConsumeBeforeWhitespace(absl::string_view value) {
     // Report whitespace after this token, but only once.
     tokenizer_.set_report_whitespace(true);
     bool result = Consume(value);
@@ -1368,7 +1373,7 @@ class TextFormat::Parser::ParserImpl {
 
   // Attempts to consume the supplied value. Returns false if a the
   // token found does not match the value specified.
-  bool TryConsume(const std::string& value) {
+  bool TryConsume(absl::string_view value) {
     if (tokenizer_.current().text == value) {
       tokenizer_.Next();
       return true;
@@ -1379,7 +1384,7 @@ class TextFormat::Parser::ParserImpl {
 
   // Similar to `TryConsume`, but the following token may be tokenized as
   // TYPE_WHITESPACE.
-  bool TryConsumeBeforeWhitespace(const std::string& value) {
+  bool TryConsumeBeforeWhitespace(absl::string_view value) {
     // Report whitespace after this token, but only once.
     tokenizer_.set_report_whitespace(true);
     bool result = TryConsume(value);
@@ -1390,8 +1395,9 @@ class TextFormat::Parser::ParserImpl {
   bool TryConsumeWhitespace() {
     had_silent_marker_ = false;
     if (LookingAtType(io::Tokenizer::TYPE_WHITESPACE)) {
-      if (tokenizer_.current().text ==
-          absl::StrCat(" ", internal::kDebugStringSilentMarkerForDetection)) {
+      absl::string_view text = tokenizer_.current().text;
+      if (absl::ConsumePrefix(&text, " ") &&
+          text == internal::kDebugStringSilentMarkerForDetection) {
         had_silent_marker_ = true;
       }
       tokenizer_.Next();
@@ -1507,17 +1513,18 @@ class TextFormat::Printer::TextGenerator
   void Print(const char* text, size_t size) override {
     if (indent_level_ > 0) {
       size_t pos = 0;  // The number of bytes we've written so far.
-      for (size_t i = 0; i < size; i++) {
-        if (text[i] == '\n') {
-          // Saw newline.  If there is more text, we may need to insert an
-          // indent here.  So, write what we have so far, including the '\n'.
-          Write(text + pos, i - pos + 1);
-          pos = i + 1;
-
-          // Setting this true will cause the next Write() to insert an indent
-          // first.
-          at_start_of_line_ = true;
-        }
+      const void* newline;
+      while (pos < size &&
+             (newline = memchr(text + pos, '\n', size - pos)) != nullptr) {
+        // Saw newline.  If there is more text, we may need to insert an
+        // indent here.  So, write what we have so far, including the '\n'.
+        size_t i = static_cast<const char*>(newline) - text;
+        Write(text + pos, i - pos + 1);
+        pos = i + 1;
+
+        // Setting this true will cause the next Write() to insert an indent
+        // first.
+        at_start_of_line_ = true;
       }
       // Write the rest.
       Write(text + pos, size - pos);
@@ -2437,7 +2444,8 @@ void TextFormat::Printer::PrintFieldValueToString(const Message& message,
   io::StringOutputStream output_stream(output);
   TextGenerator generator(&output_stream, initial_indent_level_);
 
-  PrintFieldValue(message, message.GetReflection(), field, index, &generator);
+  PrintFieldValue(message, message.GetReflection(), field, index,
+                  GetFieldPrinter(field), &generator);
 }
 
 class MapEntryMessageComparator {
@@ -2643,17 +2651,21 @@ void TextFormat::Printer::PrintField(const Message& message,
         message, reflection, field, &sorted_map_field);
   }
 
+  // The printer only depends on the field, so look it up once rather than for
+  // every element of a repeated field.
+  const FastFieldValuePrinter* printer = GetFieldPrinter(field);
+
   for (int j = 0; j < count; ++j) {
     const int field_index = field->is_repeated() ? j : -1;
 
-    PrintFieldName(message, field_index, count, reflection, field, generator);
+    PrintFieldName(message, field_index, count, reflection, field, printer,
+                   generator);
 
     if (field->cpp_type() == FieldDescriptor::CPPTYPE_MESSAGE) {
       if (TryRedactFieldValue(message, field, generator,
                               /*insert_value_separator=*/true)) {
         break;
       }
-      const FastFieldValuePrinter* printer = GetFieldPrinter(field);
       const Message& sub_message =
           field->is_repeated()
               ? (is_map ? *sorted_map_field[j]
@@ -2672,7 +2684,8 @@ void TextFormat::Printer::PrintField(const Message& message,
     } else {
       generator->PrintMaybeWithMarker(MarkerToken(), ": ");
       // Write the field value.
-      PrintFieldValue(message, reflection, field, field_index, generator);
+      PrintFieldValue(message, reflection, field, field_index, printer,
+                      generator);
       if (single_line_mode_) {
         generator->PrintLiteral(" ");
       } else {
@@ -2693,12 +2706,13 @@ void TextFormat::Printer::PrintShortRepeatedField(
     const FieldDescriptor* field, BaseTextGenerator* generator) const {
   // Print primitive repeated field in short form.
   int size = reflection->FieldSize(message, field);
+  const FastFieldValuePrinter* printer = GetFieldPrinter(field);
   PrintFieldName(message, /*field_index=*/-1, /*field_count=*/size, reflection,
-                 field, generator);
+                 field, printer, generator);
   generator->PrintMaybeWithMarker(MarkerToken(), ": ", "[");
   for (int i = 0; i < size; i++) {
     if (i > 0) generator->PrintLiteral(", ");
-    PrintFieldValue(message, reflection, field, i, generator);
+    PrintFieldValue(message, reflection, field, i, printer, generator);
   }
   if (single_line_mode_) {
     generator->PrintLiteral("] ");
@@ -2711,6 +2725,7 @@ void TextFormat::Printer::PrintFieldName(const Message& message,
                                          int field_index, int field_count,
                                          const Reflection* reflection,
                                          const FieldDescriptor* field,
+                                         const FastFieldValuePrinter* printer,
                                          BaseTextGenerator* generator) const {
   // if use_field_number_ is true, prints field number instead
   // of field name.
@@ -2719,7 +2734,6 @@ void TextFormat::Printer::PrintFieldName(const Message& message,
     return;
   }
 
-  const FastFieldValuePrinter* printer = GetFieldPrinter(field);
   printer->PrintFieldName(message, field_index, field_count, reflection, field,
                           generator);
 }
@@ -2728,11 +2742,11 @@ void TextFormat::Printer::PrintFieldValue(const Message& message,
                                           const Reflection* reflection,
                                           const FieldDescriptor* field,
                                           int index,
+                                          const FastFieldValuePrinter* printer,
                                           BaseTextGenerator* generator) const {
   ABSL_DCHECK(field->is_repeated() || (index == -1))
       << "Index must be -1 for non-repeated fields";
 
-  const FastFieldValuePrinter* printer = GetFieldPrinter(field);
   if (TryRedactFieldValue(message, field, generator,
                           /*insert_value_separator=*/false)) {
     return;
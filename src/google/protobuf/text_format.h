@@ -102,6 +102,10 @@ class PROTOBUF_EXPORT TextFormat {
 
   // Outputs a textual representation of the given message to the given
   // output stream. Returns false if printing fails.
+  //
+  // Output is written incrementally into the stream's buffers, so printing a
+  // large message to, e.g., an io::FileOutputStream uses bounded memory,
+  // unlike PrintToString().
   static bool Print(const Message& message, io::ZeroCopyOutputStream* output);
 
   // Print the fields in an UnknownFieldSet.  They are printed by tag number
@@ -491,16 +495,20 @@ class PROTOBUF_EXPORT TextFormat {
                                  BaseTextGenerator* generator) const;
 
     // Print the name of a field -- i.e. everything that comes before the
-    // ':' for a single name/value pair.
+    // ':' for a single name/value pair.  `printer` is GetFieldPrinter(field),
+    // which callers look up once per field.
     void PrintFieldName(const Message& message, int field_index,
                         int field_count, const Reflection* reflection,
                         const FieldDescriptor* field,
+                        const FastFieldValuePrinter* printer,
                         BaseTextGenerator* generator) const;
 
     // Outputs a textual representation of the value of the field supplied on
-    // the message supplied or the default value if not set.
+    // the message supplied or the default value if not set.  `printer` is
+    // GetFieldPrinter(field).
     void PrintFieldValue(const Message& message, const Reflection* reflection,
                          const FieldDescriptor* field, int index,
+                         const FastFieldValuePrinter* printer,
                          BaseTextGenerator* generator) const;
 
     // Print the fields in an UnknownFieldSet.  They are printed by tag number
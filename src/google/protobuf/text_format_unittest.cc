@@ -1581,6 +1581,36 @@ TEST_F(TextFormatTest, PrintFloatPrecision) {
             RemoveRedundantZeros(message.DebugString()));
 }
 
+TEST_F(TextFormatTest, PrintIntegralFloatingPoint) {
+  unittest::TestAllTypes message;
+
+  message.add_repeated_float(0.0f);
+  message.add_repeated_float(-0.0f);
+  message.add_repeated_float(-42.0f);
+  message.add_repeated_float(999999.0f);
+  message.add_repeated_float(1000000.0f);
+  message.add_repeated_double(0.0);
+  message.add_repeated_double(-0.0);
+  message.add_repeated_double(-42.0);
+  message.add_repeated_double(999999999999999.0);
+  message.add_repeated_double(-999999999999999.0);
+  message.add_repeated_double(1e15);
+
+  EXPECT_EQ(absl::StrCat("repeated_float: ", kDebugStringSilentMarker,
+                         "0\n"
+                         "repeated_float: -0\n"
+                         "repeated_float: -42\n"
+                         "repeated_float: 999999\n"
+                         "repeated_float: 1e+06\n"
+                         "repeated_double: 0\n"
+                         "repeated_double: -0\n"
+                         "repeated_double: -42\n"
+                         "repeated_double: 999999999999999\n"
+                         "repeated_double: -999999999999999\n"
+                         "repeated_double: 1e+15\n"),
+            RemoveRedundantZeros(message.DebugString()));
+}
+
 TEST_F(TextFormatTest, AllowPartial) {
   unittest::TestRequired message;
   TextFormat::Parser parser;
@@ -0,0 +1,94 @@
+// Protocol Buffers - Google's data interchange format
+// Copyright 2008 Google Inc.  All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include "google/protobuf/util/columnar_extractor.h"
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_split.h"
+#include "absl/strings/string_view.h"
+#include "absl/types/span.h"
+#include "google/protobuf/descriptor.h"
+#include "google/protobuf/message.h"
+
+// Must be included last.
+#include "google/protobuf/port_def.inc"
+
+namespace google {
+namespace protobuf {
+namespace util {
+
+absl::StatusOr<ColumnarExtractor> ColumnarExtractor::Create(
+    const Descriptor* descriptor, absl::Span<const std::string> field_paths) {
+  std::vector<Column> columns;
+  columns.reserve(field_paths.size());
+  for (const std::string& field_path : field_paths) {
+    Column column;
+    column.field = nullptr;
+    const Descriptor* current = descriptor;
+    for (absl::string_view name : absl::StrSplit(field_path, '.')) {
+      if (column.field != nullptr) {
+        // The previous component was not the last one, so it has to lead to
+        // a submessage.
+        if (column.field->cpp_type() != FieldDescriptor::CPPTYPE_MESSAGE ||
+            column.field->is_repeated()) {
+          return absl::InvalidArgumentError(
+              absl::StrCat("Field path \"", field_path, "\": \"",
+                           column.field->name(),
+                           "\" is not a singular message field."));
+        }
+        column.path.push_back(column.field);
+        current = column.field->message_type();
+      }
+      column.field = current->FindFieldByName(name);
+      if (column.field == nullptr) {
+        return absl::InvalidArgumentError(
+            absl::StrCat("Field path \"", field_path, "\": no field \"", name,
+                         "\" in ", current->full_name(), "."));
+      }
+    }
+    switch (column.field->cpp_type()) {
+      case FieldDescriptor::CPPTYPE_STRING:
+      case FieldDescriptor::CPPTYPE_MESSAGE:
+        return absl::InvalidArgumentError(absl::StrCat(
+            "Field path \"", field_path, "\" does not end at a scalar field."));
+      default:
+        break;
+    }
+    if (column.field->is_repeated()) {
+      return absl::InvalidArgumentError(absl::StrCat(
+          "Field path \"", field_path, "\" ends at a repeated field."));
+    }
+    columns.push_back(std::move(column));
+  }
+  return ColumnarExtractor(descriptor, std::move(columns));
+}
+
+std::vector<const Reflection*> ColumnarExtractor::PathReflections(
+    const Column& column, const Message& row) {
+  std::vector<const Reflection*> reflections;
+  reflections.reserve(column.path.size() + 1);
+  const Message* message = &row;
+  for (const FieldDescriptor* field : column.path) {
+    const Reflection* reflection = message->GetReflection();
+    reflections.push_back(reflection);
+    message = &reflection->GetMessage(*message, field);
+  }
+  reflections.push_back(message->GetReflection());
+  return reflections;
+}
+
+}  // namespace util
+}  // namespace protobuf
+}  // namespace google
+
+#include "google/protobuf/port_undef.inc"
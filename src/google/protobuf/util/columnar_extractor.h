@@ -0,0 +1,157 @@
+// Protocol Buffers - Google's data interchange format
+// Copyright 2008 Google Inc.  All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+// Defines ColumnarExtractor, which copies scalar fields out of a sequence of
+// messages into contiguous per-field arrays ("columns").
+
+#ifndef GOOGLE_PROTOBUF_UTIL_COLUMNAR_EXTRACTOR_H__
+#define GOOGLE_PROTOBUF_UTIL_COLUMNAR_EXTRACTOR_H__
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/log/absl_check.h"
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
+#include "google/protobuf/descriptor.h"
+#include "google/protobuf/message.h"
+#include "google/protobuf/repeated_ptr_field.h"
+
+// Must be included last.
+#include "google/protobuf/port_def.inc"
+
+namespace google {
+namespace protobuf {
+namespace util {
+
+// Extracts scalar columns from rows of a single message type.  For example:
+//
+//   absl::StatusOr<ColumnarExtractor> extractor = ColumnarExtractor::Create(
+//       Row::descriptor(), {"id", "location.latitude"});
+//   std::vector<int64_t> ids(rows.size());
+//   std::vector<uint8_t> ids_valid((rows.size() + 7) / 8);
+//   extractor->ExtractColumn(0, rows, ids.data(), ids_valid.data());
+//
+// Each field path is resolved once when the extractor is created.  Extracting
+// a column then reads the field at its precomputed location in every row (see
+// Reflection::GetScalarFieldAccessor()), instead of going through the checked
+// Reflection getters once per row.
+class PROTOBUF_EXPORT ColumnarExtractor {
+ public:
+  // Creates an extractor for messages of type `descriptor`.  Each entry of
+  // `field_paths` is a "."-separated list of field names that walks through
+  // singular message fields and ends at a singular scalar or enum field.
+  // Column i of the extractor corresponds to field_paths[i].
+  static absl::StatusOr<ColumnarExtractor> Create(
+      const Descriptor* descriptor, absl::Span<const std::string> field_paths);
+
+  int column_count() const { return static_cast<int>(columns_.size()); }
+
+  // The leaf field that column `column` reads.
+  const FieldDescriptor* column_field(int column) const {
+    return columns_[column].field;
+  }
+
+  // Reads column `column` from every row into `values`, which must have room
+  // for rows.size() elements.  T must match the column's field as described
+  // for Reflection::GetScalarFieldAccessor().
+  //
+  // If `validity` is not null, it receives a bitmap of (rows.size() + 7) / 8
+  // bytes in which bit i (least significant bit first) is set if row i has
+  // the field.  A row lacks the field if any message field along the path is
+  // unset, or if the leaf field has presence and is unset.  The value written
+  // for such a row is the field's default.
+  //
+  // All rows must be of the extractor's message type and share one
+  // Reflection, as messages from the same factory do.
+  template <typename T>
+  void ExtractColumn(int column, absl::Span<const Message* const> rows,
+                     T* values, uint8_t* validity) const;
+  template <typename T>
+  void ExtractColumn(int column, const RepeatedPtrField<Message>& rows,
+                     T* values, uint8_t* validity) const {
+    ExtractColumn(column, absl::MakeConstSpan(rows.data(), rows.size()),
+                  values, validity);
+  }
+
+ private:
+  struct Column {
+    // Message fields leading to `field`, outermost first.
+    std::vector<const FieldDescriptor*> path;
+    const FieldDescriptor* field;
+  };
+
+  ColumnarExtractor(const Descriptor* descriptor, std::vector<Column> columns)
+      : descriptor_(descriptor), columns_(std::move(columns)) {}
+
+  // Returns the Reflection for each message type along `column`'s path,
+  // followed by the leaf message's Reflection, taken from `row`.
+  static std::vector<const Reflection*> PathReflections(const Column& column,
+                                                        const Message& row);
+
+  const Descriptor* descriptor_;
+  std::vector<Column> columns_;
+};
+
+template <typename T>
+void ColumnarExtractor::ExtractColumn(int column,
+                                      absl::Span<const Message* const> rows,
+                                      T* values, uint8_t* validity) const {
+  ABSL_CHECK_GE(column, 0);
+  ABSL_CHECK_LT(column, column_count());
+  if (rows.empty()) return;
+  ABSL_DCHECK_EQ(rows[0]->GetDescriptor(), descriptor_);
+
+  const Column& col = columns_[column];
+  const std::vector<const Reflection*> reflections =
+      PathReflections(col, *rows[0]);
+  const ScalarFieldAccessor<T> accessor =
+      reflections.back()->GetScalarFieldAccessor<T>(col.field);
+  const bool leaf_has_presence = col.field->has_presence();
+  if (validity != nullptr) {
+    std::memset(validity, 0, (rows.size() + 7) / 8);
+  }
+
+  if (col.path.empty()) {
+    accessor.GetBatch(rows, values);
+    if (validity == nullptr) return;
+    for (size_t i = 0; i < rows.size(); ++i) {
+      if (!leaf_has_presence || accessor.Has(*rows[i])) {
+        validity[i / 8] |= static_cast<uint8_t>(1u << (i % 8));
+      }
+    }
+    return;
+  }
+
+  for (size_t i = 0; i < rows.size(); ++i) {
+    const Message* message = rows[i];
+    bool valid = true;
+    for (size_t depth = 0; depth < col.path.size(); ++depth) {
+      const Reflection* reflection = reflections[depth];
+      const FieldDescriptor* field = col.path[depth];
+      valid = valid && reflection->HasField(*message, field);
+      message = &reflection->GetMessage(*message, field);
+    }
+    values[i] = accessor.Get(*message);
+    if (validity != nullptr && valid &&
+        (!leaf_has_presence || accessor.Has(*message))) {
+      validity[i / 8] |= static_cast<uint8_t>(1u << (i % 8));
+    }
+  }
+}
+
+}  // namespace util
+}  // namespace protobuf
+}  // namespace google
+
+#include "google/protobuf/port_undef.inc"
+
+#endif  // GOOGLE_PROTOBUF_UTIL_COLUMNAR_EXTRACTOR_H__
@@ -0,0 +1,111 @@
+// Protocol Buffers - Google's data interchange format
+// Copyright 2008 Google Inc.  All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include "google/protobuf/util/columnar_extractor.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "absl/status/status.h"
+#include "google/protobuf/message.h"
+#include "google/protobuf/unittest.pb.h"
+
+namespace google {
+namespace protobuf {
+namespace util {
+namespace {
+
+using ::protobuf_unittest::TestAllTypes;
+using ::testing::ElementsAre;
+
+class ColumnarExtractorTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    for (int i = 0; i < 10; ++i) {
+      TestAllTypes* row = rows_.Add();
+      if (i % 3 != 0) row->set_optional_int64(i * 10);
+      if (i % 2 == 0) row->mutable_optional_nested_message()->set_bb(i);
+      row->set_optional_nested_enum(TestAllTypes::BAR);
+    }
+    for (const TestAllTypes& row : rows_) row_ptrs_.push_back(&row);
+  }
+
+  RepeatedPtrField<TestAllTypes> rows_;
+  std::vector<const Message*> row_ptrs_;
+};
+
+TEST_F(ColumnarExtractorTest, ExtractsTopLevelColumn) {
+  auto extractor = ColumnarExtractor::Create(
+      TestAllTypes::descriptor(), {"optional_int64", "optional_nested_enum"});
+  ASSERT_TRUE(extractor.ok()) << extractor.status();
+  EXPECT_EQ(extractor->column_count(), 2);
+
+  std::vector<int64_t> values(row_ptrs_.size());
+  uint8_t validity[2];
+  extractor->ExtractColumn(0, row_ptrs_, values.data(), validity);
+  EXPECT_THAT(values, ElementsAre(0, 10, 20, 0, 40, 50, 0, 70, 80, 0));
+  EXPECT_THAT(validity, ElementsAre(0xB6, 0x01));
+
+  std::vector<int32_t> enums(row_ptrs_.size());
+  extractor->ExtractColumn(1, row_ptrs_, enums.data(), nullptr);
+  for (int32_t value : enums) EXPECT_EQ(value, TestAllTypes::BAR);
+}
+
+TEST_F(ColumnarExtractorTest, ExtractsNestedColumn) {
+  auto extractor = ColumnarExtractor::Create(TestAllTypes::descriptor(),
+                                             {"optional_nested_message.bb"});
+  ASSERT_TRUE(extractor.ok()) << extractor.status();
+  EXPECT_EQ(extractor->column_field(0),
+            TestAllTypes::NestedMessage::descriptor()->FindFieldByName("bb"));
+
+  std::vector<int32_t> values(row_ptrs_.size());
+  uint8_t validity[2];
+  extractor->ExtractColumn(0, row_ptrs_, values.data(), validity);
+  EXPECT_THAT(values, ElementsAre(0, 0, 2, 0, 4, 0, 6, 0, 8, 0));
+  // Row 0 has the submessage, and bb set to its default value.
+  EXPECT_THAT(validity, ElementsAre(0x55, 0x01));
+}
+
+TEST_F(ColumnarExtractorTest, ExtractsFromRepeatedPtrFieldOfMessage) {
+  TestAllTypes holder;
+  for (int i = 0; i < 3; ++i) holder.add_repeated_nested_message()->set_bb(i);
+  const Reflection* reflection = holder.GetReflection();
+  const RepeatedPtrField<Message>& rows =
+      reflection->GetRepeatedPtrField<Message>(
+          holder,
+          TestAllTypes::descriptor()->FindFieldByName(
+              "repeated_nested_message"));
+
+  auto extractor = ColumnarExtractor::Create(
+      TestAllTypes::NestedMessage::descriptor(), {"bb"});
+  ASSERT_TRUE(extractor.ok()) << extractor.status();
+  int32_t values[3];
+  uint8_t validity[1];
+  extractor->ExtractColumn(0, rows, values, validity);
+  EXPECT_THAT(values, ElementsAre(0, 1, 2));
+  EXPECT_EQ(validity[0], 0x07);
+}
+
+TEST(ColumnarExtractorCreateTest, RejectsInvalidPaths) {
+  const Descriptor* descriptor = TestAllTypes::descriptor();
+  for (const char* path :
+       {"no_such_field", "optional_string", "optional_nested_message",
+        "repeated_int32", "optional_int32.bb", "repeated_nested_message.bb",
+        "optional_nested_message.no_such_field"}) {
+    EXPECT_EQ(ColumnarExtractor::Create(descriptor, {path}).status().code(),
+              absl::StatusCode::kInvalidArgument)
+        << path;
+  }
+}
+
+}  // namespace
+}  // namespace util
+}  // namespace protobuf
+}  // namespace google
@@ -10,7 +10,13 @@
 
 #include "google/protobuf/util/delimited_message_util.h"
 
+#include <cstdint>
+#include <vector>
+
+#include "absl/strings/string_view.h"
+#include "google/protobuf/arena.h"
 #include "google/protobuf/io/coded_stream.h"
+#include "google/protobuf/parse_context.h"
 
 namespace google {
 namespace protobuf {
@@ -71,6 +77,98 @@ bool ParseDelimitedFromCodedStream(MessageLite* message,
   return true;
 }
 
+bool ParseDelimitedBatchFromZeroCopyStream(
+    const MessageLite& prototype, Arena* arena, int max_messages,
+    io::ZeroCopyInputStream* input, std::vector<MessageLite*>* messages,
+    bool* clean_eof) {
+  io::CodedInputStream coded_input(input);
+  return ParseDelimitedBatchFromCodedStream(prototype, arena, max_messages,
+                                            &coded_input, messages, clean_eof);
+}
+
+namespace {
+
+// Reads a varint32 size from [ptr, end).  Returns NULL if it is not complete.
+const uint8_t* ReadSize(const uint8_t* ptr, const uint8_t* end,
+                        uint32_t* size) {
+  uint32_t result = 0;
+  for (int shift = 0; shift < 35 && ptr < end; shift += 7) {
+    uint8_t byte = *ptr++;
+    result |= static_cast<uint32_t>(byte & 0x7F) << shift;
+    if (byte < 0x80) {
+      *size = result;
+      return ptr;
+    }
+  }
+  return nullptr;
+}
+
+}  // namespace
+
+bool ParseDelimitedBatchFromCodedStream(const MessageLite& prototype,
+                                        Arena* arena, int max_messages,
+                                        io::CodedInputStream* input,
+                                        std::vector<MessageLite*>* messages,
+                                        bool* clean_eof) {
+  if (clean_eof != nullptr) *clean_eof = false;
+  while (max_messages > 0) {
+    const void* data;
+    int size;
+    if (!input->GetDirectBufferPointer(&data, &size)) {
+      if (clean_eof != nullptr) *clean_eof = true;
+      return true;
+    }
+
+    // Find the messages that lie entirely in the current buffer.
+    const uint8_t* begin = static_cast<const uint8_t*>(data);
+    const uint8_t* end = begin + size;
+    const uint8_t* ptr = begin;
+    int count = 0;
+    while (count < max_messages) {
+      uint32_t message_size;
+      const uint8_t* next = ReadSize(ptr, end, &message_size);
+      if (next == nullptr || message_size > static_cast<size_t>(end - next)) {
+        break;
+      }
+      ptr = next + message_size;
+      ++count;
+    }
+
+    if (count == 0) {
+      // The next message straddles the end of the buffer.
+      MessageLite* message = prototype.New(arena);
+      if (!ParseDelimitedFromCodedStream(message, input, nullptr)) {
+        if (arena == nullptr) delete message;
+        return false;
+      }
+      messages->push_back(message);
+      --max_messages;
+      continue;
+    }
+
+    // Parse all of them with one context.  ParseMessage() reads each size,
+    // limits the parse to it and checks that the message ended exactly there.
+    const char* parse_ptr;
+    internal::ParseContext ctx(
+        input->RecursionBudget(), /* aliasing */ false, &parse_ptr,
+        absl::string_view(reinterpret_cast<const char*>(begin), ptr - begin));
+    ctx.data().pool = input->GetExtensionPool();
+    ctx.data().factory = input->GetExtensionFactory();
+    for (int i = 0; i < count; ++i) {
+      MessageLite* message = prototype.New(arena);
+      parse_ptr = ctx.ParseMessage(message, parse_ptr);
+      if (parse_ptr == nullptr || !message->IsInitialized()) {
+        if (arena == nullptr) delete message;
+        return false;
+      }
+      messages->push_back(message);
+    }
+    input->Skip(static_cast<int>(ptr - begin));
+    max_messages -= count;
+  }
+  return true;
+}
+
 bool SerializeDelimitedToZeroCopyStream(const MessageLite& message,
                                         io::ZeroCopyOutputStream* output) {
   io::CodedOutputStream coded_output(output);
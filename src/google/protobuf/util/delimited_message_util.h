@@ -12,7 +12,9 @@
 #define GOOGLE_PROTOBUF_UTIL_DELIMITED_MESSAGE_UTIL_H__
 
 #include <ostream>
+#include <vector>
 
+#include "google/protobuf/arena.h"
 #include "google/protobuf/io/coded_stream.h"
 #include "google/protobuf/io/zero_copy_stream_impl.h"
 #include "google/protobuf/message_lite.h"
@@ -65,6 +67,29 @@ bool PROTOBUF_EXPORT ParseDelimitedFromCodedStream(MessageLite* message,
                                                    io::CodedInputStream* input,
                                                    bool* clean_eof);
 
+// Read up to |max_messages| consecutive size-delimited messages from the given
+// stream.  Each message is created with prototype.New(arena) and appended to
+// |messages|; if |arena| is NULL the caller takes ownership of them.  This is
+// much cheaper than calling ParseDelimitedFromZeroCopyStream() in a loop for
+// streams of many small messages: the stream is set up once per call, and
+// all messages that lie in the same input buffer are parsed with one parser
+// context.
+//
+// Returns false if a message could not be parsed; the messages before it are
+// still appended.  Otherwise returns true, even if fewer than |max_messages|
+// messages were left.  If |clean_eof| is not NULL, it is set to whether the
+// stream ended at a message boundary before |max_messages| were read.  The
+// same buffering caveats as for ParseDelimitedFromZeroCopyStream() apply.
+bool PROTOBUF_EXPORT ParseDelimitedBatchFromZeroCopyStream(
+    const MessageLite& prototype, Arena* arena, int max_messages,
+    io::ZeroCopyInputStream* input, std::vector<MessageLite*>* messages,
+    bool* clean_eof);
+
+bool PROTOBUF_EXPORT ParseDelimitedBatchFromCodedStream(
+    const MessageLite& prototype, Arena* arena, int max_messages,
+    io::CodedInputStream* input, std::vector<MessageLite*>* messages,
+    bool* clean_eof);
+
 // Write a single size-delimited message from the given stream. Delimited
 // format allows a single file or stream to contain multiple messages,
 // whereas normally writing multiple non-delimited messages to the same
@@ -11,9 +11,13 @@
 #include "google/protobuf/util/delimited_message_util.h"
 
 #include <sstream>
+#include <string>
+#include <vector>
 
 #include "google/protobuf/testing/googletest.h"
 #include <gtest/gtest.h>
+#include "google/protobuf/arena.h"
+#include "google/protobuf/io/zero_copy_stream_impl_lite.h"
 #include "google/protobuf/test_util.h"
 #include "google/protobuf/unittest.pb.h"
 
@@ -88,6 +92,90 @@ TEST(DelimitedMessageUtilTest, FailsAtEndOfStream) {
   }
 }
 
+TEST(DelimitedMessageUtilTest, BatchParse) {
+  std::string data;
+  {
+    io::StringOutputStream output(&data);
+    for (int i = 0; i < 100; ++i) {
+      protobuf_unittest::TestAllTypes message;
+      if (i == 50) TestUtil::SetAllFields(&message);
+      message.set_optional_int32(i);
+      EXPECT_TRUE(SerializeDelimitedToZeroCopyStream(message, &output));
+    }
+  }
+
+  for (int block_size : {1, 7, 64, -1}) {
+    Arena arena;
+    io::ArrayInputStream input(data.data(), data.size(), block_size);
+    std::vector<MessageLite*> messages;
+    bool clean_eof = true;
+    int next = 0;
+    while (next < 100) {
+      messages.clear();
+      EXPECT_TRUE(ParseDelimitedBatchFromZeroCopyStream(
+          protobuf_unittest::TestAllTypes::default_instance(), &arena, 9,
+          &input, &messages, &clean_eof));
+      if (next + 9 < 100) {
+        EXPECT_FALSE(clean_eof);
+        ASSERT_EQ(messages.size(), size_t{9});
+      }
+      for (MessageLite* message : messages) {
+        auto* typed = static_cast<protobuf_unittest::TestAllTypes*>(message);
+        EXPECT_EQ(typed->GetArena(), &arena);
+        EXPECT_EQ(typed->optional_int32(), next);
+        if (next == 50) {
+          typed->set_optional_int32(101);
+          TestUtil::ExpectAllFieldsSet(*typed);
+        }
+        ++next;
+      }
+
+      // Batches stop exactly after the last message, so the stream can be
+      // read with the other functions in between.
+      if (next < 100) {
+        protobuf_unittest::TestAllTypes message;
+        EXPECT_TRUE(ParseDelimitedFromZeroCopyStream(&message, &input,
+                                                     &clean_eof));
+        EXPECT_EQ(message.optional_int32(), next);
+        ++next;
+      }
+    }
+    EXPECT_EQ(next, 100);
+
+    messages.clear();
+    EXPECT_TRUE(ParseDelimitedBatchFromZeroCopyStream(
+        protobuf_unittest::TestAllTypes::default_instance(), &arena, 9, &input,
+        &messages, &clean_eof));
+    EXPECT_TRUE(clean_eof);
+    EXPECT_TRUE(messages.empty());
+  }
+}
+
+TEST(DelimitedMessageUtilTest, BatchParseFailsOnTruncatedMessage) {
+  std::string data;
+  {
+    io::StringOutputStream output(&data);
+    protobuf_unittest::ForeignMessage message;
+    message.set_c(42);
+    EXPECT_TRUE(SerializeDelimitedToZeroCopyStream(message, &output));
+    message.set_d(24);
+    EXPECT_TRUE(SerializeDelimitedToZeroCopyStream(message, &output));
+  }
+  data.pop_back();
+
+  io::ArrayInputStream input(data.data(), data.size());
+  std::vector<MessageLite*> messages;
+  bool clean_eof = true;
+  EXPECT_FALSE(ParseDelimitedBatchFromZeroCopyStream(
+      protobuf_unittest::ForeignMessage::default_instance(), nullptr, 10,
+      &input, &messages, &clean_eof));
+  EXPECT_FALSE(clean_eof);
+  ASSERT_EQ(messages.size(), size_t{1});
+  EXPECT_EQ(static_cast<protobuf_unittest::ForeignMessage*>(messages[0])->c(),
+            42);
+  delete messages[0];
+}
+
 }  // namespace util
 }  // namespace protobuf
 }  // namespace google
@@ -0,0 +1,389 @@
+// Protocol Buffers - Google's data interchange format
+// Copyright 2008 Google Inc.  All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include "google/protobuf/util/record_file.h"
+
+#include <algorithm>
+#include <climits>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+
+#include "absl/crc/crc32c.h"
+#include "absl/functional/function_ref.h"
+#include "absl/log/absl_log.h"
+#include "absl/memory/memory.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "google/protobuf/io/coded_stream.h"
+#include "google/protobuf/io/zero_copy_stream_impl_lite.h"
+
+#if HAVE_ZLIB
+#include "zlib.h"
+#endif
+
+// Must be included last.
+#include "google/protobuf/port_def.inc"
+
+namespace google {
+namespace protobuf {
+namespace util {
+namespace {
+
+constexpr absl::string_view kMagic("pbrec\x01\r\n", 8);
+// index_offset, index_size, index checksum, flags, magic.
+constexpr size_t kFooterSize = 8 + 8 + 4 + 4 + kMagic.size();
+// The low byte of the flags holds the RecordFileCompression.
+constexpr uint32_t kCompressionMask = 0xff;
+constexpr uint32_t kChecksumFlag = 1 << 8;
+// Deflate compresses data by at most this factor, so a larger
+// uncompressed_size in the index is corrupt.
+constexpr uint64_t kMaxDeflateRatio = 1032;
+
+uint32_t Crc32c(absl::string_view data) {
+  return static_cast<uint32_t>(absl::ComputeCrc32c(data));
+}
+
+RecordFileWriter::Options CheckOptions(RecordFileWriter::Options options) {
+#if !HAVE_ZLIB
+  if (options.compression == RecordFileCompression::kZlib) {
+    ABSL_LOG(DFATAL) << "Record file compression requires zlib; writing "
+                        "uncompressed blocks.";
+    options.compression = RecordFileCompression::kNone;
+  }
+#endif
+  return options;
+}
+
+}  // namespace
+
+// ===================================================================
+
+RecordFileWriter::RecordFileWriter(io::ZeroCopyOutputStream* output)
+    : RecordFileWriter(output, Options()) {}
+
+RecordFileWriter::RecordFileWriter(io::ZeroCopyOutputStream* output,
+                                   const Options& options)
+    : output_(output), options_(CheckOptions(options)) {
+  output_.WriteRaw(kMagic.data(), static_cast<int>(kMagic.size()));
+}
+
+RecordFileWriter::~RecordFileWriter() {
+  if (!closed_) Close();
+}
+
+bool RecordFileWriter::WriteRecord(const MessageLite& message) {
+  if (closed_) return false;
+  size_t size = message.ByteSizeLong();
+  if (size > INT_MAX) return false;
+  message.SerializeWithCachedSizesToArray(AppendRecord(size));
+  return FinishRecord();
+}
+
+bool RecordFileWriter::WriteSerializedRecord(absl::string_view record) {
+  if (closed_) return false;
+  if (record.size() > INT_MAX) return false;
+  memcpy(AppendRecord(record.size()), record.data(), record.size());
+  return FinishRecord();
+}
+
+uint8_t* RecordFileWriter::AppendRecord(size_t size) {
+  const uint32_t size32 = static_cast<uint32_t>(size);
+  const size_t old_size = block_.size();
+  block_.resize(old_size + io::CodedOutputStream::VarintSize32(size32) + size);
+  return io::CodedOutputStream::WriteVarint32ToArray(
+      size32, reinterpret_cast<uint8_t*>(&block_[old_size]));
+}
+
+bool RecordFileWriter::FinishRecord() {
+  ++block_records_;
+  ++record_count_;
+  if (block_.size() >= options_.block_size) return FlushBlock();
+  return !output_.HadError();
+}
+
+void RecordFileWriter::WriteStored(absl::string_view data) {
+  // WriteRaw() takes an int.
+  while (!data.empty()) {
+    int chunk = static_cast<int>(std::min<size_t>(data.size(), INT_MAX));
+    output_.WriteRaw(data.data(), chunk);
+    data.remove_prefix(chunk);
+  }
+}
+
+bool RecordFileWriter::FlushBlock() {
+  if (block_records_ == 0) return !output_.HadError();
+
+  RecordFileBlock info;
+  info.offset = static_cast<uint64_t>(output_.ByteCount());
+  info.uncompressed_size = block_.size();
+  info.first_record = record_count_ - block_records_;
+  info.record_count = block_records_;
+
+  absl::string_view stored = block_;
+#if HAVE_ZLIB
+  std::string compressed;
+  if (options_.compression == RecordFileCompression::kZlib) {
+    uLongf compressed_size = compressBound(block_.size());
+    compressed.resize(compressed_size);
+    int error = compress2(reinterpret_cast<Bytef*>(&compressed[0]),
+                          &compressed_size,
+                          reinterpret_cast<const Bytef*>(block_.data()),
+                          block_.size(), Z_DEFAULT_COMPRESSION);
+    if (error != Z_OK) return false;
+    compressed.resize(compressed_size);
+    stored = compressed;
+  }
+#endif
+
+  info.stored_size = stored.size();
+  if (options_.checksum) info.crc32c = Crc32c(stored);
+  WriteStored(stored);
+
+  blocks_.push_back(info);
+  block_.clear();
+  block_records_ = 0;
+  return !output_.HadError();
+}
+
+bool RecordFileWriter::Close() {
+  if (closed_) return !output_.HadError();
+  closed_ = true;
+  bool ok = FlushBlock();
+
+  std::string index;
+  {
+    io::StringOutputStream index_stream(&index);
+    io::CodedOutputStream index_output(&index_stream);
+    for (const RecordFileBlock& block : blocks_) {
+      index_output.WriteVarint64(block.offset);
+      index_output.WriteVarint64(block.stored_size);
+      index_output.WriteVarint64(block.uncompressed_size);
+      index_output.WriteVarint64(static_cast<uint64_t>(block.record_count));
+      index_output.WriteLittleEndian32(block.crc32c);
+    }
+  }
+
+  uint32_t flags = static_cast<uint32_t>(options_.compression);
+  if (options_.checksum) flags |= kChecksumFlag;
+  const uint64_t index_offset = static_cast<uint64_t>(output_.ByteCount());
+  WriteStored(index);
+  output_.WriteLittleEndian64(index_offset);
+  output_.WriteLittleEndian64(index.size());
+  output_.WriteLittleEndian32(Crc32c(index));
+  output_.WriteLittleEndian32(flags);
+  output_.WriteRaw(kMagic.data(), static_cast<int>(kMagic.size()));
+  output_.Trim();
+  return ok && !output_.HadError();
+}
+
+// ===================================================================
+
+absl::StatusOr<std::unique_ptr<RecordFileReader>> RecordFileReader::Open(
+    absl::string_view contents) {
+  if (contents.size() < kMagic.size() + kFooterSize ||
+      !absl::StartsWith(contents, kMagic) ||
+      !absl::EndsWith(contents, kMagic)) {
+    return absl::InvalidArgumentError("Not a record file.");
+  }
+
+  const size_t footer_offset = contents.size() - kFooterSize;
+  const uint8_t* footer =
+      reinterpret_cast<const uint8_t*>(contents.data() + footer_offset);
+  uint64_t index_offset;
+  uint64_t index_size;
+  uint32_t index_crc32c;
+  uint32_t flags;
+  footer = io::CodedInputStream::ReadLittleEndian64FromArray(footer,
+                                                             &index_offset);
+  footer = io::CodedInputStream::ReadLittleEndian64FromArray(footer,
+                                                             &index_size);
+  footer = io::CodedInputStream::ReadLittleEndian32FromArray(footer,
+                                                             &index_crc32c);
+  io::CodedInputStream::ReadLittleEndian32FromArray(footer, &flags);
+  if (index_offset < kMagic.size() || index_offset > footer_offset ||
+      index_size != footer_offset - index_offset || index_size > INT_MAX) {
+    return absl::DataLossError("Corrupt record file footer.");
+  }
+  absl::string_view index = contents.substr(index_offset, index_size);
+  if (Crc32c(index) != index_crc32c) {
+    return absl::DataLossError("Record file index checksum mismatch.");
+  }
+
+  RecordFileCompression compression;
+  switch (flags & kCompressionMask) {
+    case static_cast<uint32_t>(RecordFileCompression::kNone):
+      compression = RecordFileCompression::kNone;
+      break;
+    case static_cast<uint32_t>(RecordFileCompression::kZlib):
+#if !HAVE_ZLIB
+      return absl::UnimplementedError(
+          "Record file is compressed, but zlib is not available.");
+#endif
+      compression = RecordFileCompression::kZlib;
+      break;
+    default:
+      return absl::InvalidArgumentError(
+          absl::StrCat("Unknown record file compression ",
+                       flags & kCompressionMask, "."));
+  }
+
+  auto reader = absl::WrapUnique(new RecordFileReader(
+      contents, compression, (flags & kChecksumFlag) != 0));
+  io::CodedInputStream input(reinterpret_cast<const uint8_t*>(index.data()),
+                             static_cast<int>(index.size()));
+  // Blocks are contiguous and fill the space between the magic and the index.
+  uint64_t next_offset = kMagic.size();
+  while (input.CurrentPosition() < static_cast<int>(index.size())) {
+    RecordFileBlock block;
+    uint64_t record_count;
+    if (!input.ReadVarint64(&block.offset) ||
+        !input.ReadVarint64(&block.stored_size) ||
+        !input.ReadVarint64(&block.uncompressed_size) ||
+        !input.ReadVarint64(&record_count) ||
+        !input.ReadLittleEndian32(&block.crc32c) ||
+        block.offset != next_offset ||
+        block.stored_size > index_offset - block.offset || record_count == 0 ||
+        record_count > block.uncompressed_size ||
+        // The buffer for a block is sized from uncompressed_size, so it must
+        // be consistent with what is stored.  ReadBlock() could not handle
+        // more than INT_MAX bytes anyway.  stored_size is bounded by the file
+        // size, so the product below can't overflow.
+        block.uncompressed_size > INT_MAX ||
+        (compression == RecordFileCompression::kNone
+             ? block.uncompressed_size != block.stored_size
+             : block.uncompressed_size >
+                   block.stored_size * kMaxDeflateRatio)) {
+      return absl::DataLossError("Corrupt record file index.");
+    }
+    block.first_record = reader->record_count_;
+    block.record_count = static_cast<int64_t>(record_count);
+    reader->record_count_ += block.record_count;
+    next_offset += block.stored_size;
+    reader->blocks_.push_back(block);
+  }
+  if (next_offset != index_offset) {
+    return absl::DataLossError("Corrupt record file index.");
+  }
+  return reader;
+}
+
+int RecordFileReader::FindBlock(int64_t record_index) const {
+  if (record_index < 0 || record_index >= record_count_) return -1;
+  auto it = std::upper_bound(
+      blocks_.begin(), blocks_.end(), record_index,
+      [](int64_t index, const RecordFileBlock& block) {
+        return index < block.first_record;
+      });
+  return static_cast<int>(it - blocks_.begin()) - 1;
+}
+
+absl::StatusOr<absl::string_view> RecordFileReader::BlockContents(
+    int block_index, std::string* buffer) const {
+  const RecordFileBlock& block = blocks_[block_index];
+  absl::string_view stored = contents_.substr(block.offset, block.stored_size);
+  if (checksum_ && Crc32c(stored) != block.crc32c) {
+    return absl::DataLossError(
+        absl::StrCat("Checksum mismatch in record file block ", block_index,
+                     "."));
+  }
+  if (compression_ == RecordFileCompression::kNone) {
+    if (stored.size() != block.uncompressed_size) {
+      return absl::DataLossError(
+          absl::StrCat("Corrupt record file block ", block_index, "."));
+    }
+    return stored;
+  }
+
+#if HAVE_ZLIB
+  buffer->resize(block.uncompressed_size);
+  uLongf size = static_cast<uLongf>(block.uncompressed_size);
+  int error = uncompress(reinterpret_cast<Bytef*>(&(*buffer)[0]), &size,
+                         reinterpret_cast<const Bytef*>(stored.data()),
+                         stored.size());
+  if (error != Z_OK || size != block.uncompressed_size) {
+    return absl::DataLossError(
+        absl::StrCat("Failed to decompress record file block ", block_index,
+                     "."));
+  }
+  return absl::string_view(*buffer);
+#else
+  return absl::UnimplementedError("zlib is not available.");
+#endif
+}
+
+absl::Status RecordFileReader::ReadBlock(
+    int block_index,
+    absl::FunctionRef<bool(absl::string_view record)> fn) const {
+  if (block_index < 0 || block_index >= block_count()) {
+    return absl::OutOfRangeError(
+        absl::StrCat("No record file block ", block_index, "."));
+  }
+  std::string buffer;
+  absl::StatusOr<absl::string_view> contents =
+      BlockContents(block_index, &buffer);
+  if (!contents.ok()) return contents.status();
+
+  if (contents->size() > INT_MAX) {
+    return absl::DataLossError(
+        absl::StrCat("Record file block ", block_index, " is too large."));
+  }
+  const int size = static_cast<int>(contents->size());
+  io::CodedInputStream input(
+      reinterpret_cast<const uint8_t*>(contents->data()), size);
+  for (int64_t i = 0; i < blocks_[block_index].record_count; ++i) {
+    uint32_t record_size;
+    if (!input.ReadVarint32(&record_size) ||
+        record_size > static_cast<uint32_t>(size - input.CurrentPosition())) {
+      return absl::DataLossError(
+          absl::StrCat("Corrupt record in record file block ", block_index,
+                       "."));
+    }
+    if (!fn(contents->substr(input.CurrentPosition(), record_size))) {
+      return absl::OkStatus();
+    }
+    input.Skip(static_cast<int>(record_size));
+  }
+  if (input.CurrentPosition() != size) {
+    return absl::DataLossError(
+        absl::StrCat("Trailing data in record file block ", block_index, "."));
+  }
+  return absl::OkStatus();
+}
+
+absl::Status RecordFileReader::ReadRecord(int64_t record_index,
+                                          MessageLite* message) const {
+  int block_index = FindBlock(record_index);
+  if (block_index < 0) {
+    return absl::OutOfRangeError(
+        absl::StrCat("No record ", record_index, " in record file."));
+  }
+  int64_t skip = record_index - blocks_[block_index].first_record;
+  bool parsed = false;
+  absl::Status status =
+      ReadBlock(block_index, [&](absl::string_view record) {
+        if (skip-- > 0) return true;
+        parsed = message->ParseFromString(record);
+        return false;
+      });
+  if (!status.ok()) return status;
+  if (!parsed) {
+    return absl::DataLossError(
+        absl::StrCat("Failed to parse record ", record_index, "."));
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace util
+}  // namespace protobuf
+}  // namespace google
+
+#include "google/protobuf/port_undef.inc"
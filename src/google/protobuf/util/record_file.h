@@ -0,0 +1,182 @@
+// Protocol Buffers - Google's data interchange format
+// Copyright 2008 Google Inc.  All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+// Defines RecordFileWriter and RecordFileReader, which store a sequence of
+// messages in a file that can be read by record number.
+//
+// Records are written in the delimited format used by
+// delimited_message_util.h (a varint length followed by the serialized
+// message), grouped into blocks of roughly Options::block_size bytes.  Blocks
+// may be compressed and checksummed individually.  An index of all blocks is
+// written at the end of the file, followed by a fixed-size footer:
+//
+//   file   := magic block* index footer
+//   magic  := "pbrec\x01\r\n"
+//   block  := delimited record*, compressed if the footer says so
+//   index  := entry*, where each entry is
+//             varint offset, varint stored_size, varint uncompressed_size,
+//             varint record_count, fixed32 crc32c(stored bytes)
+//   footer := fixed64 index_offset, fixed64 index_size,
+//             fixed32 crc32c(index), fixed32 flags, magic
+//
+// A reader only needs the footer and the index to find the block holding a
+// given record, and blocks can be decoded independently, e.g. on different
+// threads.
+
+#ifndef GOOGLE_PROTOBUF_UTIL_RECORD_FILE_H__
+#define GOOGLE_PROTOBUF_UTIL_RECORD_FILE_H__
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/functional/function_ref.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "google/protobuf/io/coded_stream.h"
+#include "google/protobuf/io/zero_copy_stream.h"
+#include "google/protobuf/message_lite.h"
+
+// Must be included last.
+#include "google/protobuf/port_def.inc"
+
+namespace google {
+namespace protobuf {
+namespace util {
+
+enum class RecordFileCompression {
+  kNone = 0,
+  // Each block is a zlib stream.  Requires protobuf to be built with zlib.
+  kZlib = 1,
+};
+
+// Describes one block of a record file.
+struct RecordFileBlock {
+  // Location of the block's stored (possibly compressed) bytes in the file.
+  uint64_t offset = 0;
+  uint64_t stored_size = 0;
+  uint64_t uncompressed_size = 0;
+  // Index of the first record in the block, and number of records.
+  int64_t first_record = 0;
+  int64_t record_count = 0;
+  // CRC-32C of the stored bytes, or 0 if the file has no checksums.
+  uint32_t crc32c = 0;
+};
+
+// Writes a record file to a ZeroCopyOutputStream.  The file is only readable
+// once Close() has written the index.
+class PROTOBUF_EXPORT RecordFileWriter {
+ public:
+  struct Options {
+    // Records are added to a block until it holds at least this many bytes.
+    // Smaller blocks make random access cheaper; larger ones compress better.
+    size_t block_size = 64 << 10;
+    RecordFileCompression compression = RecordFileCompression::kNone;
+    // Whether to store a CRC-32C of each block and verify it when reading.
+    bool checksum = true;
+  };
+
+  explicit RecordFileWriter(io::ZeroCopyOutputStream* output);
+  RecordFileWriter(io::ZeroCopyOutputStream* output, const Options& options);
+  RecordFileWriter(const RecordFileWriter&) = delete;
+  RecordFileWriter& operator=(const RecordFileWriter&) = delete;
+  // Calls Close() if it has not been called yet.
+  ~RecordFileWriter();
+
+  // Appends a record.  Returns false if the message is too large or writing
+  // to the underlying stream failed.
+  bool WriteRecord(const MessageLite& message);
+  // Appends a record that is already serialized.
+  bool WriteSerializedRecord(absl::string_view record);
+
+  // Writes the last block, the index and the footer.  It is the caller's
+  // responsibility to flush or close the underlying stream.  Returns false if
+  // any write failed.
+  bool Close();
+
+  // Number of records written so far.
+  int64_t record_count() const { return record_count_; }
+
+ private:
+  // Reserves room for a record of `size` bytes at the end of block_, writes
+  // its length prefix and returns where the record itself goes.
+  uint8_t* AppendRecord(size_t size);
+  bool FinishRecord();
+  bool FlushBlock();
+  void WriteStored(absl::string_view data);
+
+  io::CodedOutputStream output_;
+  const Options options_;
+  // Delimited records of the block being built.
+  std::string block_;
+  int64_t block_records_ = 0;
+  int64_t record_count_ = 0;
+  std::vector<RecordFileBlock> blocks_;
+  bool closed_ = false;
+};
+
+// Reads a record file held in memory, typically a memory-mapped file.  The
+// reader does not copy the contents, which must outlive it.  All const
+// methods may be called concurrently from several threads, for example to
+// decode different blocks in parallel.
+class PROTOBUF_EXPORT RecordFileReader {
+ public:
+  // Reads the footer and index of `contents`.  Returns an error if they are
+  // malformed; the blocks themselves are only checked when read.
+  static absl::StatusOr<std::unique_ptr<RecordFileReader>> Open(
+      absl::string_view contents);
+
+  RecordFileReader(const RecordFileReader&) = delete;
+  RecordFileReader& operator=(const RecordFileReader&) = delete;
+
+  int64_t record_count() const { return record_count_; }
+  int block_count() const { return static_cast<int>(blocks_.size()); }
+  const RecordFileBlock& block(int index) const { return blocks_[index]; }
+  RecordFileCompression compression() const { return compression_; }
+
+  // Returns the index of the block holding record `record_index`, or -1 if
+  // there is no such record.
+  int FindBlock(int64_t record_index) const;
+
+  // Calls `fn` with each serialized record of block `block_index`, in order,
+  // until it returns false.  The records point into `contents` or into a
+  // temporary buffer, and are only valid during the call.
+  absl::Status ReadBlock(
+      int block_index,
+      absl::FunctionRef<bool(absl::string_view record)> fn) const;
+
+  // Parses record `record_index` into `message`.  Only the block holding the
+  // record is decoded.
+  absl::Status ReadRecord(int64_t record_index, MessageLite* message) const;
+
+ private:
+  RecordFileReader(absl::string_view contents,
+                   RecordFileCompression compression, bool checksum)
+      : contents_(contents), compression_(compression), checksum_(checksum) {}
+
+  // Returns the uncompressed contents of a block, using `buffer` if it needs
+  // to be decompressed.
+  absl::StatusOr<absl::string_view> BlockContents(int block_index,
+                                                  std::string* buffer) const;
+
+  absl::string_view contents_;
+  RecordFileCompression compression_;
+  bool checksum_;
+  std::vector<RecordFileBlock> blocks_;
+  int64_t record_count_ = 0;
+};
+
+}  // namespace util
+}  // namespace protobuf
+}  // namespace google
+
+#include "google/protobuf/port_undef.inc"
+
+#endif  // GOOGLE_PROTOBUF_UTIL_RECORD_FILE_H__
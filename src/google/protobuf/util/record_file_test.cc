@@ -0,0 +1,266 @@
+// Protocol Buffers - Google's data interchange format
+// Copyright 2008 Google Inc.  All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include "google/protobuf/util/record_file.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "absl/crc/crc32c.h"
+#include "absl/status/status.h"
+#include "absl/strings/string_view.h"
+#include "google/protobuf/io/coded_stream.h"
+#include "google/protobuf/io/zero_copy_stream_impl_lite.h"
+#include "google/protobuf/test_util.h"
+#include "google/protobuf/unittest.pb.h"
+
+namespace google {
+namespace protobuf {
+namespace util {
+namespace {
+
+using ::protobuf_unittest::TestAllTypes;
+using ::testing::HasSubstr;
+
+constexpr int kRecordCount = 200;
+
+std::string WriteTestFile(const RecordFileWriter::Options& options) {
+  std::string contents;
+  io::StringOutputStream output(&contents);
+  RecordFileWriter writer(&output, options);
+  for (int i = 0; i < kRecordCount; ++i) {
+    TestAllTypes message;
+    if (i % 7 == 0) TestUtil::SetAllFields(&message);
+    message.set_optional_int32(i);
+    EXPECT_TRUE(writer.WriteRecord(message));
+  }
+  EXPECT_EQ(writer.record_count(), kRecordCount);
+  EXPECT_TRUE(writer.Close());
+  return contents;
+}
+
+class RecordFileTest
+    : public testing::TestWithParam<std::tuple<RecordFileCompression, bool>> {
+ protected:
+  RecordFileWriter::Options MakeOptions() const {
+    RecordFileWriter::Options options;
+    options.block_size = 1000;
+    options.compression = std::get<0>(GetParam());
+    options.checksum = std::get<1>(GetParam());
+    return options;
+  }
+};
+
+TEST_P(RecordFileTest, RandomAccess) {
+  std::string contents = WriteTestFile(MakeOptions());
+  auto reader = RecordFileReader::Open(contents);
+  ASSERT_TRUE(reader.ok()) << reader.status();
+  EXPECT_EQ((*reader)->record_count(), kRecordCount);
+  EXPECT_EQ((*reader)->compression(), std::get<0>(GetParam()));
+  EXPECT_GT((*reader)->block_count(), 1);
+
+  for (int i : {kRecordCount - 1, 0, 7, 100, 1}) {
+    TestAllTypes message;
+    ASSERT_TRUE((*reader)->ReadRecord(i, &message).ok());
+    EXPECT_EQ(message.optional_int32(), i);
+    if (i % 7 == 0) {
+      message.set_optional_int32(101);
+      TestUtil::ExpectAllFieldsSet(message);
+    }
+  }
+
+  TestAllTypes message;
+  EXPECT_EQ((*reader)->ReadRecord(kRecordCount, &message).code(),
+            absl::StatusCode::kOutOfRange);
+  EXPECT_EQ((*reader)->FindBlock(-1), -1);
+  EXPECT_EQ((*reader)->FindBlock(kRecordCount), -1);
+}
+
+TEST_P(RecordFileTest, ReadBlocks) {
+  std::string contents = WriteTestFile(MakeOptions());
+  auto reader = RecordFileReader::Open(contents);
+  ASSERT_TRUE(reader.ok()) << reader.status();
+
+  int64_t next = 0;
+  for (int b = 0; b < (*reader)->block_count(); ++b) {
+    const RecordFileBlock& block = (*reader)->block(b);
+    EXPECT_EQ(block.first_record, next);
+    int64_t last_record = block.first_record + block.record_count - 1;
+    EXPECT_EQ((*reader)->FindBlock(block.first_record), b);
+    EXPECT_EQ((*reader)->FindBlock(last_record), b);
+    ASSERT_TRUE((*reader)
+                    ->ReadBlock(b,
+                                [&](absl::string_view record) {
+                                  TestAllTypes message;
+                                  EXPECT_TRUE(message.ParseFromString(record));
+                                  EXPECT_EQ(message.optional_int32(), next);
+                                  ++next;
+                                  return true;
+                                })
+                    .ok());
+  }
+  EXPECT_EQ(next, kRecordCount);
+}
+
+TEST_P(RecordFileTest, CorruptBlock) {
+  std::string contents = WriteTestFile(MakeOptions());
+  // Flip a bit in the first block, just after the magic.
+  contents[10] ^= 1;
+  auto reader = RecordFileReader::Open(contents);
+  ASSERT_TRUE(reader.ok()) << reader.status();
+  TestAllTypes message;
+  absl::Status status = (*reader)->ReadRecord(0, &message);
+  if (std::get<1>(GetParam())) {
+    EXPECT_EQ(status.code(), absl::StatusCode::kDataLoss);
+    EXPECT_THAT(status.message(), HasSubstr("Checksum mismatch"));
+  }
+  // Other blocks are unaffected.
+  int last_block = (*reader)->block_count() - 1;
+  EXPECT_TRUE((*reader)->ReadBlock(last_block, [](absl::string_view) {
+    return true;
+  }).ok());
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    RecordFileTest, RecordFileTest,
+    testing::Combine(testing::Values(RecordFileCompression::kNone
+#if HAVE_ZLIB
+                                     ,
+                                     RecordFileCompression::kZlib
+#endif
+                                     ),
+                     testing::Bool()));
+
+TEST(RecordFileReaderTest, RejectsBadFiles) {
+  std::string contents = WriteTestFile(RecordFileWriter::Options());
+  EXPECT_EQ(RecordFileReader::Open("").status().code(),
+            absl::StatusCode::kInvalidArgument);
+  EXPECT_EQ(RecordFileReader::Open(contents.substr(0, contents.size() - 1))
+                .status()
+                .code(),
+            absl::StatusCode::kInvalidArgument);
+
+  // The 32-byte footer is preceded by the index.
+  std::string corrupt_index = contents;
+  corrupt_index[contents.size() - 33] ^= 1;
+  EXPECT_EQ(RecordFileReader::Open(corrupt_index).status().code(),
+            absl::StatusCode::kDataLoss);
+}
+
+// Returns a file holding `block` as its only block, with a valid index that
+// claims it inflates to `uncompressed_size` bytes.
+std::string MakeSingleBlockFile(absl::string_view block,
+                                uint64_t uncompressed_size,
+                                RecordFileCompression compression) {
+  constexpr absl::string_view kMagic("pbrec\x01\r\n", 8);
+  std::string index;
+  {
+    io::StringOutputStream index_stream(&index);
+    io::CodedOutputStream index_output(&index_stream);
+    index_output.WriteVarint64(kMagic.size());
+    index_output.WriteVarint64(block.size());
+    index_output.WriteVarint64(uncompressed_size);
+    index_output.WriteVarint64(1);
+    index_output.WriteLittleEndian32(0);
+  }
+  std::string contents;
+  {
+    io::StringOutputStream output_stream(&contents);
+    io::CodedOutputStream output(&output_stream);
+    output.WriteString(std::string(kMagic));
+    output.WriteString(std::string(block));
+    output.WriteString(index);
+    output.WriteLittleEndian64(kMagic.size() + block.size());
+    output.WriteLittleEndian64(index.size());
+    output.WriteLittleEndian32(
+        static_cast<uint32_t>(absl::ComputeCrc32c(index)));
+    output.WriteLittleEndian32(static_cast<uint32_t>(compression));
+    output.WriteString(std::string(kMagic));
+  }
+  return contents;
+}
+
+TEST(RecordFileReaderTest, RejectsCorruptBlockSizes) {
+  const std::string kBlock = "0123456789";
+  // Sanity check: consistent sizes are accepted.
+  EXPECT_TRUE(
+      RecordFileReader::Open(MakeSingleBlockFile(kBlock, kBlock.size(),
+                                                 RecordFileCompression::kNone))
+          .ok());
+  EXPECT_EQ(RecordFileReader::Open(
+                MakeSingleBlockFile(kBlock, uint64_t{1} << 40,
+                                    RecordFileCompression::kNone))
+                .status()
+                .code(),
+            absl::StatusCode::kDataLoss);
+#if HAVE_ZLIB
+  // A plausible size is only rejected once the block fails to inflate.
+  auto reader = RecordFileReader::Open(
+      MakeSingleBlockFile(kBlock, 1000, RecordFileCompression::kZlib));
+  ASSERT_TRUE(reader.ok()) << reader.status();
+  EXPECT_EQ((*reader)->ReadBlock(0, [](absl::string_view) { return true; })
+                .code(),
+            absl::StatusCode::kDataLoss);
+  // Sizes that no deflate stream of this size could produce, or that do not
+  // fit in an int, are rejected without allocating a buffer for them.
+  for (uint64_t size : {uint64_t{1} << 40, uint64_t{1} << 31,
+                        uint64_t{1033} * kBlock.size()}) {
+    EXPECT_EQ(RecordFileReader::Open(
+                  MakeSingleBlockFile(kBlock, size,
+                                      RecordFileCompression::kZlib))
+                  .status()
+                  .code(),
+              absl::StatusCode::kDataLoss)
+        << size;
+  }
+#endif
+}
+
+TEST(RecordFileReaderTest, EmptyFile) {
+  std::string contents;
+  {
+    io::StringOutputStream output(&contents);
+    RecordFileWriter writer(&output);
+  }
+  auto reader = RecordFileReader::Open(contents);
+  ASSERT_TRUE(reader.ok()) << reader.status();
+  EXPECT_EQ((*reader)->record_count(), 0);
+  EXPECT_EQ((*reader)->block_count(), 0);
+}
+
+TEST(RecordFileWriterTest, SerializedRecords) {
+  std::string contents;
+  {
+    io::StringOutputStream output(&contents);
+    RecordFileWriter writer(&output);
+    EXPECT_TRUE(writer.WriteSerializedRecord("abc"));
+    EXPECT_TRUE(writer.WriteSerializedRecord(""));
+    EXPECT_TRUE(writer.Close());
+    EXPECT_FALSE(writer.WriteSerializedRecord("too late"));
+  }
+  auto reader = RecordFileReader::Open(contents);
+  ASSERT_TRUE(reader.ok()) << reader.status();
+  std::vector<std::string> records;
+  EXPECT_TRUE((*reader)
+                  ->ReadBlock(0,
+                              [&](absl::string_view record) {
+                                records.emplace_back(record);
+                                return true;
+                              })
+                  .ok());
+  EXPECT_THAT(records, testing::ElementsAre("abc", ""));
+}
+
+}  // namespace
+}  // namespace util
+}  // namespace protobuf
+}  // namespace google
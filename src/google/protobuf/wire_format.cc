@@ -1334,6 +1334,46 @@ uint8_t* WireFormat::InternalSerializeField(const FieldDescriptor* field,
     return target;
   }
 
+  // Repeated scalars are written straight from the underlying RepeatedField,
+  // avoiding a reflection call (and for enums, a descriptor lookup) per
+  // element.
+  if (field->is_repeated()) {
+    switch (field->type()) {
+#define HANDLE_PRIMITIVE_TYPE(TYPE, CPPTYPE, TYPE_METHOD)                      \
+  case FieldDescriptor::TYPE_##TYPE: {                                         \
+    for (CPPTYPE value :                                                       \
+         message_reflection->GetRepeatedFieldInternal<CPPTYPE>(message,        \
+                                                               field)) {       \
+      target = stream->EnsureSpace(target);                                    \
+      target = WireFormatLite::Write##TYPE_METHOD##ToArray(field->number(),    \
+                                                           value, target);     \
+    }                                                                          \
+    return target;                                                             \
+  }
+
+      HANDLE_PRIMITIVE_TYPE(INT32, int32_t, Int32)
+      HANDLE_PRIMITIVE_TYPE(INT64, int64_t, Int64)
+      HANDLE_PRIMITIVE_TYPE(SINT32, int32_t, SInt32)
+      HANDLE_PRIMITIVE_TYPE(SINT64, int64_t, SInt64)
+      HANDLE_PRIMITIVE_TYPE(UINT32, uint32_t, UInt32)
+      HANDLE_PRIMITIVE_TYPE(UINT64, uint64_t, UInt64)
+      HANDLE_PRIMITIVE_TYPE(ENUM, int, Enum)
+
+      HANDLE_PRIMITIVE_TYPE(FIXED32, uint32_t, Fixed32)
+      HANDLE_PRIMITIVE_TYPE(FIXED64, uint64_t, Fixed64)
+      HANDLE_PRIMITIVE_TYPE(SFIXED32, int32_t, SFixed32)
+      HANDLE_PRIMITIVE_TYPE(SFIXED64, int64_t, SFixed64)
+
+      HANDLE_PRIMITIVE_TYPE(FLOAT, float, Float)
+      HANDLE_PRIMITIVE_TYPE(DOUBLE, double, Double)
+
+      HANDLE_PRIMITIVE_TYPE(BOOL, bool, Bool)
+#undef HANDLE_PRIMITIVE_TYPE
+      default:
+        break;
+    }
+  }
+
   auto get_message_from_field = [&message, &map_entries, message_reflection](
                                     const FieldDescriptor* field, int j) {
     if (!field->is_repeated()) {
@@ -1390,12 +1430,9 @@ uint8_t* WireFormat::InternalSerializeField(const FieldDescriptor* field,
       } break;
 
       case FieldDescriptor::TYPE_ENUM: {
-        const EnumValueDescriptor* value =
-            field->is_repeated()
-                ? message_reflection->GetRepeatedEnum(message, field, j)
-                : message_reflection->GetEnum(message, field);
-        target = WireFormatLite::WriteEnumToArray(field->number(),
-                                                  value->number(), target);
+        target = WireFormatLite::WriteEnumToArray(
+            field->number(), message_reflection->GetEnumValue(message, field),
+            target);
         break;
       }
 
@@ -1680,17 +1717,32 @@ size_t WireFormat::FieldDataOnlyByteSize(const FieldDescriptor* field,
     }                                                                       \
     break;
 
+// Repeated varints are sized straight from the underlying RepeatedField
+// rather than through one reflection call per element.
+#define HANDLE_VARINT_TYPE(TYPE, TYPE_METHOD, CPPTYPE, CPPTYPE_METHOD)        \
+  case FieldDescriptor::TYPE_##TYPE:                                          \
+    if (field->is_repeated()) {                                               \
+      data_size += WireFormatLite::TYPE_METHOD##Size(                         \
+          message_reflection->GetRepeatedFieldInternal<CPPTYPE>(message,      \
+                                                                field));      \
+    } else {                                                                  \
+      data_size += WireFormatLite::TYPE_METHOD##Size(                         \
+          message_reflection->Get##CPPTYPE_METHOD(message, field));           \
+    }                                                                         \
+    break;
+
 #define HANDLE_FIXED_TYPE(TYPE, TYPE_METHOD)                   \
   case FieldDescriptor::TYPE_##TYPE:                           \
     data_size += count * WireFormatLite::k##TYPE_METHOD##Size; \
     break;
 
-    HANDLE_TYPE(INT32, Int32, Int32)
-    HANDLE_TYPE(INT64, Int64, Int64)
-    HANDLE_TYPE(SINT32, SInt32, Int32)
-    HANDLE_TYPE(SINT64, SInt64, Int64)
-    HANDLE_TYPE(UINT32, UInt32, UInt32)
-    HANDLE_TYPE(UINT64, UInt64, UInt64)
+    HANDLE_VARINT_TYPE(INT32, Int32, int32_t, Int32)
+    HANDLE_VARINT_TYPE(INT64, Int64, int64_t, Int64)
+    HANDLE_VARINT_TYPE(SINT32, SInt32, int32_t, Int32)
+    HANDLE_VARINT_TYPE(SINT64, SInt64, int64_t, Int64)
+    HANDLE_VARINT_TYPE(UINT32, UInt32, uint32_t, UInt32)
+    HANDLE_VARINT_TYPE(UINT64, UInt64, uint64_t, UInt64)
+    HANDLE_VARINT_TYPE(ENUM, Enum, int, EnumValue)
 
     HANDLE_FIXED_TYPE(FIXED32, Fixed32)
     HANDLE_FIXED_TYPE(FIXED64, Fixed64)
@@ -1705,21 +1757,9 @@ size_t WireFormat::FieldDataOnlyByteSize(const FieldDescriptor* field,
     HANDLE_TYPE(GROUP, Group, Message)
     HANDLE_TYPE(MESSAGE, Message, Message)
 #undef HANDLE_TYPE
+#undef HANDLE_VARINT_TYPE
 #undef HANDLE_FIXED_TYPE
 
-    case FieldDescriptor::TYPE_ENUM: {
-      if (field->is_repeated()) {
-        for (size_t j = 0; j < count; j++) {
-          data_size += WireFormatLite::EnumSize(
-              message_reflection->GetRepeatedEnum(message, field, j)->number());
-        }
-      } else {
-        data_size += WireFormatLite::EnumSize(
-            message_reflection->GetEnum(message, field)->number());
-      }
-      break;
-    }
-
     // Handle strings separately so that we can get string references
     // instead of copying.
     case FieldDescriptor::TYPE_STRING:
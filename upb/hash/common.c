@@ -433,6 +433,16 @@ void upb_strtable_clear(upb_strtable* t) {
   memset((char*)t->t.entries, 0, bytes);
 }
 
+bool upb_strtable_reserve(upb_strtable* t, size_t n, upb_Arena* a) {
+  // Each resize re-copies every key into the arena, so growing once up front
+  // is much cheaper than doubling repeatedly while inserting.
+  size_t need = t->t.count + n;
+  size_t size_lg2 = t->t.size_lg2;
+  while ((size_t)(((size_t)1 << size_lg2) * MAX_LOAD) < need) size_lg2++;
+  if (size_lg2 == t->t.size_lg2) return true;
+  return upb_strtable_resize(t, size_lg2, a);
+}
+
 bool upb_strtable_resize(upb_strtable* t, size_t size_lg2, upb_Arena* a) {
   upb_strtable new_table;
   if (!init(&new_table.t, size_lg2, a)) return false;
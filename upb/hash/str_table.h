@@ -32,6 +32,11 @@ UPB_INLINE size_t upb_strtable_count(const upb_strtable* t) {
 
 void upb_strtable_clear(upb_strtable* t);
 
+// Grows the table, if necessary, so that `n` more keys can be inserted without
+// triggering a resize. Returns false if memory allocation failed, in which case
+// the table is unchanged.
+bool upb_strtable_reserve(upb_strtable* t, size_t n, upb_Arena* a);
+
 // Inserts the given key into the hashtable with the given value.
 // The key must not already exist in the hash table. The key is not required
 // to be NULL-terminated, and the table will make an internal copy of the key.
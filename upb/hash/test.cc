@@ -238,3 +238,31 @@ TEST(Table, Init) {
     upb_strtable_init(&t, i, arena.ptr());
   }
 }
+
+TEST(Table, Reserve) {
+  upb::Arena arena;
+  upb_strtable t;
+  ASSERT_TRUE(upb_strtable_init(&t, 0, arena.ptr()));
+  ASSERT_TRUE(upb_strtable_reserve(&t, 1000, arena.ptr()));
+
+  // Inserting the reserved number of keys must not resize the table.
+  const upb_tabent* entries = t.t.entries;
+  for (int i = 0; i < 1000; i++) {
+    std::string key = std::to_string(i);
+    ASSERT_TRUE(upb_strtable_insert(&t, key.data(), key.size(),
+                                    upb_value_int32(i), arena.ptr()));
+  }
+  EXPECT_EQ(entries, t.t.entries);
+  EXPECT_EQ(1000, upb_strtable_count(&t));
+
+  // Reserving room that is already available is a no-op.
+  ASSERT_TRUE(upb_strtable_reserve(&t, 0, arena.ptr()));
+  EXPECT_EQ(entries, t.t.entries);
+
+  for (int i = 0; i < 1000; i++) {
+    std::string key = std::to_string(i);
+    upb_value v;
+    ASSERT_TRUE(upb_strtable_lookup2(&t, key.data(), key.size(), &v));
+    EXPECT_EQ(i, upb_value_getint32(v));
+  }
+}
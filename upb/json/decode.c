@@ -429,7 +429,10 @@ static void jsondec_resize(jsondec* d, char** buf, char** end, char** buf_end) {
   *buf_end = *buf + size;
 }
 
-static upb_StringView jsondec_string(jsondec* d) {
+/* Parses a JSON string. If `alias` is true and the string contains no escape
+ * sequences, the returned view points into the input buffer and is not
+ * NUL-terminated; otherwise it is a NUL-terminated copy on the arena. */
+static upb_StringView jsondec_stringimpl(jsondec* d, bool alias) {
   char* buf = NULL;
   char* end = NULL;
   char* buf_end = NULL;
@@ -440,6 +443,28 @@ static upb_StringView jsondec_string(jsondec* d) {
     jsondec_err(d, "Expected string");
   }
 
+  /* Fast path: most strings have no escapes, so find the closing quote first
+   * and then alias or copy the whole span with a single allocation. */
+  const char* p = d->ptr;
+  while (p < d->end && *p != '"' && *p != '\\' && (unsigned char)*p >= 0x20) {
+    p++;
+  }
+  if (p < d->end && *p == '"') {
+    upb_StringView ret;
+    ret.size = p - d->ptr;
+    if (alias) {
+      ret.data = d->ptr;
+    } else {
+      buf = upb_Arena_Malloc(d->arena, ret.size + 1);
+      if (!buf) jsondec_err(d, "Out of memory");
+      memcpy(buf, d->ptr, ret.size);
+      buf[ret.size] = '\0'; /* Needed for possible strtod(). */
+      ret.data = buf;
+    }
+    d->ptr = p + 1;
+    return ret;
+  }
+
   while (d->ptr < d->end) {
     char ch = *d->ptr++;
 
@@ -481,6 +506,10 @@ eof:
   jsondec_err(d, "EOF inside string");
 }
 
+static upb_StringView jsondec_string(jsondec* d) {
+  return jsondec_stringimpl(d, false);
+}
+
 static void jsondec_skipval(jsondec* d) {
   switch (jsondec_peek(d)) {
     case JD_OBJECT:
@@ -780,9 +809,13 @@ static upb_MessageValue jsondec_double(jsondec* d, const upb_FieldDef* f) {
 /* Parse STRING or BYTES value. */
 static upb_MessageValue jsondec_strfield(jsondec* d, const upb_FieldDef* f) {
   upb_MessageValue val;
-  val.str_val = jsondec_string(d);
   if (upb_FieldDef_CType(f) == kUpb_CType_Bytes) {
+    /* Base64 is decoded in place, so bytes always need their own copy. */
+    val.str_val = jsondec_string(d);
     val.str_val.size = jsondec_base64(d, val.str_val);
+  } else {
+    val.str_val =
+        jsondec_stringimpl(d, d->options & upb_JsonDecode_AliasString);
   }
   return val;
 }
@@ -17,7 +17,15 @@
 extern "C" {
 #endif
 
-enum { upb_JsonDecode_IgnoreUnknown = 1 };
+enum {
+  upb_JsonDecode_IgnoreUnknown = 1,
+
+  /* If set, string fields whose JSON value contains no escape sequences will
+   * point directly into the input buffer instead of being copied onto the
+   * arena, like kUpb_DecodeOption_AliasString does for the binary decoder.
+   * The input buffer must then outlive the message. */
+  upb_JsonDecode_AliasString = 2,
+};
 
 UPB_API bool upb_JsonDecode(const char* buf, size_t size, upb_Message* msg,
                             const upb_MessageDef* m, const upb_DefPool* symtab,
@@ -96,3 +96,44 @@ TEST(JsonTest, AcceptsTrailingWhitespace) {
   upb_test_Box* box = JsonDecode(json_string.c_str(), a.ptr());
   EXPECT_NE(box, nullptr);
 }
+
+TEST(JsonTest, DecodeStrings) {
+  upb::Arena a;
+  upb_test_Box* box = JsonDecode(R"({"name": "plain"})", a.ptr());
+  ASSERT_NE(box, nullptr);
+  upb_StringView name = upb_test_Box_name(box);
+  EXPECT_EQ(std::string(name.data, name.size), "plain");
+
+  box = JsonDecode(R"({"name": "esc\"apedé"})", a.ptr());
+  ASSERT_NE(box, nullptr);
+  name = upb_test_Box_name(box);
+  EXPECT_EQ(std::string(name.data, name.size), "esc\"aped\xc3\xa9");
+}
+
+TEST(JsonTest, AliasString) {
+  upb::Arena a;
+  upb::Status status;
+  upb::DefPool defpool;
+  upb::MessageDefPtr m(upb_test_Box_getmsgdef(defpool.ptr()));
+
+  std::string json = R"({"name": "plain"})";
+  upb_test_Box* box = upb_test_Box_new(a.ptr());
+  ASSERT_TRUE(upb_JsonDecode(json.data(), json.size(), box, m.ptr(),
+                             defpool.ptr(), upb_JsonDecode_AliasString, a.ptr(),
+                             status.ptr()));
+  upb_StringView name = upb_test_Box_name(box);
+  EXPECT_EQ(std::string(name.data, name.size), "plain");
+  EXPECT_GE(name.data, json.data());
+  EXPECT_LT(name.data, json.data() + json.size());
+
+  // Strings with escapes still need to be unescaped into a copy.
+  json = R"({"name": "a\tb"})";
+  box = upb_test_Box_new(a.ptr());
+  ASSERT_TRUE(upb_JsonDecode(json.data(), json.size(), box, m.ptr(),
+                             defpool.ptr(), upb_JsonDecode_AliasString, a.ptr(),
+                             status.ptr()));
+  name = upb_test_Box_name(box);
+  EXPECT_EQ(std::string(name.data, name.size), "a\tb");
+  EXPECT_TRUE(name.data < json.data() ||
+              name.data >= json.data() + json.size());
+}
@@ -8,7 +8,10 @@
 #include "upb/lex/round_trip.h"
 
 #include <float.h>
+#include <math.h>
+#include <stdint.h>
 #include <stdlib.h>
+#include <string.h>
 
 // Must be last.
 #include "upb/port/def.inc"
@@ -26,8 +29,35 @@ static void upb_FixLocale(char* p) {
   }
 }
 
+/* Writes `val` as a decimal integer if it is integral and its magnitude is
+ * below `limit`, which must be 10^precision. That is exactly what "%.*g"
+ * would print, and it always round-trips, so the callers below can return
+ * without calling snprintf() and strtod(). Returns false otherwise, including
+ * for NaN and infinities. */
+static bool upb_EncodeIntegral(double val, double limit, char* buf) {
+  if (!(val > -limit && val < limit)) return false;
+  const int64_t integral = (int64_t)val;
+  if ((double)integral != val) return false;
+
+  char digits[24];
+  char* end = digits + sizeof(digits);
+  char* p = end;
+  uint64_t magnitude =
+      integral < 0 ? 0 - (uint64_t)integral : (uint64_t)integral;
+  do {
+    *--p = (char)('0' + magnitude % 10);
+    magnitude /= 10;
+  } while (magnitude != 0);
+  /* signbit() also catches -0.0, which "%g" prints as "-0". */
+  if (signbit(val)) *--p = '-';
+  memcpy(buf, p, end - p);
+  buf[end - p] = '\0';
+  return true;
+}
+
 void _upb_EncodeRoundTripDouble(double val, char* buf, size_t size) {
   assert(size >= kUpb_RoundTripBufferSize);
+  if (upb_EncodeIntegral(val, 1e15, buf)) return;  /* 10^DBL_DIG */
   snprintf(buf, size, "%.*g", DBL_DIG, val);
   if (strtod(buf, NULL) != val) {
     snprintf(buf, size, "%.*g", DBL_DIG + 2, val);
@@ -38,6 +68,7 @@ void _upb_EncodeRoundTripDouble(double val, char* buf, size_t size) {
 
 void _upb_EncodeRoundTripFloat(float val, char* buf, size_t size) {
   assert(size >= kUpb_RoundTripBufferSize);
+  if (upb_EncodeIntegral(val, 1e6, buf)) return;  /* 10^FLT_DIG */
   snprintf(buf, size, "%.*g", FLT_DIG, val);
   if (strtof(buf, NULL) != val) {
     snprintf(buf, size, "%.*g", FLT_DIG + 3, val);
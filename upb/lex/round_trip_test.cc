@@ -0,0 +1,74 @@
+// Protocol Buffers - Google's data interchange format
+// Copyright 2023 Google LLC.  All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include "upb/lex/round_trip.h"
+
+#include <stdlib.h>
+
+#include <limits>
+#include <string>
+
+#include <gtest/gtest.h>
+
+namespace {
+
+std::string EncodeDouble(double val) {
+  char buf[kUpb_RoundTripBufferSize];
+  _upb_EncodeRoundTripDouble(val, buf, sizeof(buf));
+  EXPECT_EQ(strtod(buf, nullptr), val) << buf;
+  return buf;
+}
+
+std::string EncodeFloat(float val) {
+  char buf[kUpb_RoundTripBufferSize];
+  _upb_EncodeRoundTripFloat(val, buf, sizeof(buf));
+  EXPECT_EQ(strtof(buf, nullptr), val) << buf;
+  return buf;
+}
+
+TEST(RoundTripTest, Double) {
+  EXPECT_EQ(EncodeDouble(0.0), "0");
+  EXPECT_EQ(EncodeDouble(-0.0), "-0");
+  EXPECT_EQ(EncodeDouble(1.0), "1");
+  EXPECT_EQ(EncodeDouble(-42.0), "-42");
+  EXPECT_EQ(EncodeDouble(1e15 - 1), "999999999999999");
+  EXPECT_EQ(EncodeDouble(-(1e15 - 1)), "-999999999999999");
+  EXPECT_EQ(EncodeDouble(1e15), "1e+15");
+  EXPECT_EQ(EncodeDouble(1e16), "1e+16");
+  EXPECT_EQ(EncodeDouble(1e16 + 2), "10000000000000002");
+  EXPECT_EQ(EncodeDouble(1.5), "1.5");
+  EXPECT_EQ(EncodeDouble(0.1), "0.1");
+  EXPECT_EQ(EncodeDouble(std::numeric_limits<double>::max()),
+            "1.7976931348623157e+308");
+}
+
+TEST(RoundTripTest, Float) {
+  EXPECT_EQ(EncodeFloat(0.0f), "0");
+  EXPECT_EQ(EncodeFloat(-0.0f), "-0");
+  EXPECT_EQ(EncodeFloat(999999.0f), "999999");
+  EXPECT_EQ(EncodeFloat(-999999.0f), "-999999");
+  EXPECT_EQ(EncodeFloat(1e6f), "1e+06");
+  EXPECT_EQ(EncodeFloat(16777216.0f), "16777216");
+  EXPECT_EQ(EncodeFloat(0.1f), "0.1");
+  EXPECT_EQ(EncodeFloat(std::numeric_limits<float>::max()),
+            "3.40282347e+38");
+}
+
+TEST(RoundTripTest, Infinity) {
+  char buf[kUpb_RoundTripBufferSize];
+  _upb_EncodeRoundTripDouble(std::numeric_limits<double>::infinity(), buf,
+                             sizeof(buf));
+  EXPECT_STREQ(buf, "inf");
+  _upb_EncodeRoundTripDouble(-std::numeric_limits<double>::infinity(), buf,
+                             sizeof(buf));
+  EXPECT_STREQ(buf, "-inf");
+  _upb_EncodeRoundTripFloat(std::numeric_limits<float>::infinity(), buf,
+                            sizeof(buf));
+  EXPECT_STREQ(buf, "inf");
+}
+
+}  // namespace
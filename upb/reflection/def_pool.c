@@ -160,6 +160,10 @@ bool _upb_DefPool_InsertSym(upb_DefPool* s, upb_StringView sym, upb_value v,
   return true;
 }
 
+bool _upb_DefPool_ReserveSyms(upb_DefPool* s, size_t n) {
+  return upb_strtable_reserve(&s->syms, n, s->arena);
+}
+
 static const void* _upb_DefPool_Unpack(const upb_DefPool* s, const char* sym,
                                        size_t size, upb_deftype_t type) {
   upb_value v;
@@ -194,6 +194,58 @@ static int count_exts_in_msg(const UPB_DESC(DescriptorProto) * msg_proto) {
   return ext_count;
 }
 
+static size_t count_enum_syms(const UPB_DESC(EnumDescriptorProto) *
+                              enum_proto) {
+  size_t n;
+  UPB_DESC(EnumDescriptorProto_value)(enum_proto, &n);
+  return 1 + n;
+}
+
+// Counts the symbols that a message adds to the pool: the message itself and
+// its nested messages, enums, enum values and extensions.
+static size_t count_syms_in_msg(const UPB_DESC(DescriptorProto) * msg_proto) {
+  size_t n;
+  UPB_DESC(DescriptorProto_extension)(msg_proto, &n);
+  size_t sym_count = 1 + n;
+
+  const UPB_DESC(EnumDescriptorProto)* const* enums =
+      UPB_DESC(DescriptorProto_enum_type)(msg_proto, &n);
+  for (size_t i = 0; i < n; i++) {
+    sym_count += count_enum_syms(enums[i]);
+  }
+
+  const UPB_DESC(DescriptorProto)* const* nested_msgs =
+      UPB_DESC(DescriptorProto_nested_type)(msg_proto, &n);
+  for (size_t i = 0; i < n; i++) {
+    sym_count += count_syms_in_msg(nested_msgs[i]);
+  }
+
+  return sym_count;
+}
+
+static size_t count_syms_in_file(const UPB_DESC(FileDescriptorProto) *
+                                 file_proto) {
+  size_t n;
+  UPB_DESC(FileDescriptorProto_extension)(file_proto, &n);
+  size_t sym_count = n;
+  UPB_DESC(FileDescriptorProto_service)(file_proto, &n);
+  sym_count += n;
+
+  const UPB_DESC(EnumDescriptorProto)* const* enums =
+      UPB_DESC(FileDescriptorProto_enum_type)(file_proto, &n);
+  for (size_t i = 0; i < n; i++) {
+    sym_count += count_enum_syms(enums[i]);
+  }
+
+  const UPB_DESC(DescriptorProto)* const* msgs =
+      UPB_DESC(FileDescriptorProto_message_type)(file_proto, &n);
+  for (size_t i = 0; i < n; i++) {
+    sym_count += count_syms_in_msg(msgs[i]);
+  }
+
+  return sym_count;
+}
+
 const UPB_DESC(FeatureSet*)
     _upb_FileDef_FindEdition(upb_DefBuilder* ctx, int edition) {
   const UPB_DESC(FeatureSetDefaults)* defaults =
@@ -263,6 +315,13 @@ void _upb_FileDef_Create(upb_DefBuilder* ctx,
   }
   file->ext_count = ext_count;
 
+  // Size the pool's symbol table for every symbol in this file up front, so
+  // that adding them doesn't rehash the table (and re-copy its keys) as it
+  // grows.
+  if (!_upb_DefPool_ReserveSyms(ctx->symtab, count_syms_in_file(file_proto))) {
+    _upb_DefBuilder_OomErr(ctx);
+  }
+
   if (ctx->layout) {
     // We are using the ext layouts that were passed in.
     file->ext_layouts = ctx->layout->UPB_PRIVATE(exts);
@@ -26,6 +26,7 @@ bool _upb_DefPool_InsertExt(upb_DefPool* s, const upb_MiniTableExtension* ext,
                             const upb_FieldDef* f);
 bool _upb_DefPool_InsertSym(upb_DefPool* s, upb_StringView sym, upb_value v,
                             upb_Status* status);
+bool _upb_DefPool_ReserveSyms(upb_DefPool* s, size_t n);
 bool _upb_DefPool_LookupSym(const upb_DefPool* s, const char* sym, size_t size,
                             upb_value* v);
 